@@ -32,7 +32,7 @@
 //----------------------------------------------------------------------------
 
 //! The current id of the exercise (this must be changed every two weeks).
-#define VERSUCH 2
+#define VERSUCH 3
 
 //----------------------------------------------------------------------------
 // System constants
@@ -49,6 +49,21 @@
 //! Standard priority for newly created processes
 #define DEFAULT_PRIORITY            2
 
+/*!
+ *  Number of process groups the fair-share strategy divides the CPU among
+ *  (may be nothing > 8). Every process belongs to exactly one group.
+ */
+#define MAX_NUMBER_OF_GROUPS        4
+
+//! Group newly created processes are placed in
+#define DEFAULT_GROUP               0
+
+//! Group of the system processes (task manager, shell, telemetry, compactor)
+#define SYSTEM_GROUP                (MAX_NUMBER_OF_GROUPS - 1)
+
+//! Standard shares of a process group
+#define DEFAULT_GROUP_SHARES        1
+
 //! Default delay to read display values (in ms)
 #ifndef DEFAULT_OUTPUT_DELAY
 #define DEFAULT_OUTPUT_DELAY        100
@@ -61,6 +76,100 @@
 //! Number to specify an invalid process
 #define INVALID_PROCESS             255
 
+//! Number of scheduler calls over which the CPU usage of process groups is measured
+#define GROUP_USAGE_WINDOW          128
+
+//! Number of queues of the multi-level feedback queue strategy (level i has a quantum of 2^i)
+#define MLFQ_LEVELS                 4
+
+//! Number of scheduler calls after which all processes are moved back to the top queue
+#define MLFQ_BOOST_PERIOD           64
+
+//! Maximum number of minor frames in the major frame of a cyclic schedule (may be nothing > 32)
+#define CYCLIC_MAX_FRAMES           32
+
+//! Scheduler tick period in microseconds after startup (see os_setTickPeriod)
+#define DEFAULT_TICK_PERIOD         3125
+
+//! Shortest scheduler tick period in microseconds, shorter ticks leave no time to the processes
+#define MIN_TICK_PERIOD             100
+
+//----------------------------------------------------------------------------
+// Clock governor constants
+//----------------------------------------------------------------------------
+
+//! Whether the clock governor is active after startup (see os_setClockGovernor)
+#define DEFAULT_CLOCK_GOVERNOR      false
+
+//! CPU utilization in percent above which the governor doubles the clock
+#define GOVERNOR_UP_THRESHOLD       80
+
+//! CPU utilization in percent below which the governor halves the clock
+#define GOVERNOR_DOWN_THRESHOLD     30
+
+//! Largest clock division the governor chooses (3 = clock_div_8, 2.5 MHz)
+#define GOVERNOR_MAX_DIVISION       3
+
+//! Processes with at least this priority restore the full clock when they become ready
+#define GOVERNOR_BOOST_PRIORITY     10
+
+//----------------------------------------------------------------------------
+// Pipe constants
+//----------------------------------------------------------------------------
+
+//! Number of pipes that may be open at the same time
+#define MAX_NUMBER_OF_PIPES         4
+
+//! Number of bytes a pipe buffers before writers block
+#define PIPE_BUFFER_SIZE            32
+
+//----------------------------------------------------------------------------
+// Heap constants
+//----------------------------------------------------------------------------
+
+//! Number of movable allocations that may exist at the same time (may be nothing > 255)
+#define MAX_NUMBER_OF_HANDLES       16
+
+//! Period in ms after which the compactor looks for holes again once the heaps are compact
+#define COMPACTION_PERIOD           250
+
+//! Number of chunks the compactor copies per critical section
+#define COMPACTION_CHUNKS           8
+
+//----------------------------------------------------------------------------
+// USART constants
+//----------------------------------------------------------------------------
+
+//! Baud rate of USART0 (8 data bits, no parity, 1 stop bit)
+#define USART_BAUD_RATE             38400
+
+//! Number of received bytes buffered until a process reads them (must be a power of two <= 128)
+#define USART_RX_BUFFER_SIZE        32
+
+//! Number of bytes buffered for sending before writers block (must be a power of two <= 128)
+#define USART_TX_BUFFER_SIZE        64
+
+//----------------------------------------------------------------------------
+// Telemetry constants
+//----------------------------------------------------------------------------
+
+//! Default period between two telemetry snapshots in ms (0 pauses the telemetry)
+#define TELEMETRY_PERIOD            1000
+
+//----------------------------------------------------------------------------
+// Trace constants
+//----------------------------------------------------------------------------
+
+//! Number of events the trace buffer keeps (must be a power of two <= 128, 0 disables tracing)
+#define TRACE_BUFFER_SIZE           64
+
+//----------------------------------------------------------------------------
+// Log constants
+//----------------------------------------------------------------------------
+
+//! Size of the log ring buffer in bytes (must be a power of two <= 128)
+#define LOG_BUFFER_SIZE             128
+
 //----------------------------------------------------------------------------
 // Stack constants
 //----------------------------------------------------------------------------
@@ -11,26 +11,107 @@
  */
 
 #include "lcd.h"
+#include "os_format.h"
 #ifdef VERSUCH
     #include "util.h"
 #endif
+#if SPOS_CONFIG
+    #include "os_scheduler.h"
+    #include "os_trace.h"
+    //! Marks the start or the end of a transfer to the LCD in the trace
+    #define lcd_trace(TYPE) os_trace(TYPE, os_getCurrentProc())
+#else
+    #define lcd_trace(TYPE)
+#endif
 
 #pragma GCC push_options
 #pragma GCC optimize ("O3")
 
 #include <stdio.h>
+#include <string.h>
 #include <avr/interrupt.h>
 #include <avr/io.h>
 #include <util/atomic.h>
 #include <util/delay.h>
 
-//! Global var, stores character count.
+//! A virtual 2x16 console, holding what would be on the LCD
+typedef struct LcdConsole {
+    //! The characters of both lines (already mapped to the character set of the LCD)
+    char text[32];
+
+    //! Stores character count.
+    /*!
+     *  \internal
+     *  This value is in [0;32]
+     *       ... yes, this is no mistake it can be both 0 and 32
+     */
+    uint8_t counter;
+
+    //! Set between lcd_beginFrame and lcd_endFrame, output only goes to the text then
+    bool framed;
+} LcdConsole;
+
+#if SPOS_CONFIG
+    //! Number of virtual consoles, console 0 is shared by all processes without their own console
+    #define LCD_CONSOLES MAX_NUMBER_OF_PROCESSES
+#else
+    //! Without SPOS there is only the shared console
+    #define LCD_CONSOLES 1
+#endif
+
+//! Index of the console that is written while the LCD is accessed directly
+#define LCD_DIRECT LCD_CONSOLES
+
+//! The consoles of the processes plus the one for direct access
+static LcdConsole consoles[LCD_CONSOLES + 1];
+
+//! Bit i is set if process i writes to its own console
+static uint8_t consoleOwners = 0;
+
+//! The console shown on the LCD
+static uint8_t foreground = 0;
+
+//! Nesting depth of lcd_beginDirect
+static uint8_t directDepth = 0;
+
+//! What the LCD currently shows, so frames only send the characters that changed
+static char panel[32];
+
+/*!
+ *  Determines the console the calling process writes to.
+ *  \internal
+ */
+static uint8_t lcd_consoleIndex(void) {
+    if (directDepth) {
+        return LCD_DIRECT;
+    }
+#if SPOS_CONFIG
+    ProcessID const pid = os_getCurrentProc();
+    if (consoleOwners & (1 << pid)) {
+        return pid;
+    }
+#endif
+    return 0;
+}
+
+/*!
+ *  The console the calling process writes to.
+ *  \internal
+ */
+static LcdConsole *lcd_console(void) {
+    return &consoles[lcd_consoleIndex()];
+}
+
 /*!
+ *  Whether output of the calling process goes to the LCD as well.
  *  \internal
- *  This value is in [0;32]
- *       ... yes, this is no mistake it can be both 0 and 32
  */
-uint8_t charCtr;
+static bool lcd_visible(void) {
+    uint8_t const index = lcd_consoleIndex();
+    return (index == LCD_DIRECT || index == foreground) && !consoles[index].framed;
+}
+
+static void lcd_panelCommand(uint8_t command);
 
 /*!
  *  Internally used to turn on LCD Pin EN (Enable) for 1us.
@@ -54,6 +135,17 @@ FILE *lcdout = &(FILE)FDEV_SETUP_STREAM(lcd_writeWrapper, NULL, _FDEV_SETUP_WRIT
  *  Delay times as specified with some reserve
  */
 void lcd_init(void) {
+    // Empty all consoles, the shared one is shown
+    for (uint8_t i = 0; i <= LCD_CONSOLES; i++) {
+        memset(consoles[i].text, ' ', sizeof(consoles[i].text));
+        consoles[i].counter = 0;
+        consoles[i].framed = false;
+    }
+    memset(panel, ' ', sizeof(panel));
+    consoleOwners = 0;
+    foreground = 0;
+    directDepth = 0;
+
     // Write on LCD Port (reading is not needed)
     LCD_PORT_DDR = 0xFF;
 
@@ -85,6 +177,9 @@ void lcd_init(void) {
     lcd_registerCustomChar(LCD_CC_TILDE,      LCD_CC_TILDE_BITMAP);
     lcd_registerCustomChar(LCD_CC_BACKSLASH,  LCD_CC_BACKSLASH_BITMAP);
     lcd_registerCustomChar(LCD_CC_MU,         LCD_CC_MU_BITMAP);
+    for (uint8_t columns = 1; columns <= 4; columns++) {
+        lcd_registerCustomChar(LCD_CC_BAR(columns), LCD_CC_BAR_BITMAP(columns));
+    }
 
     lcd_clear();
 }
@@ -94,7 +189,7 @@ void lcd_init(void) {
  */
 void lcd_line1(void) {
     lcd_command(LCD_LINE_1);
-    charCtr = 0;
+    lcd_console()->counter = 0;
 }
 
 /*!
@@ -102,28 +197,30 @@ void lcd_line1(void) {
  */
 void lcd_line2(void) {
     lcd_command(LCD_LINE_2);
-    charCtr = 16;
+    lcd_console()->counter = 16;
 }
 
 /*!
  * Moves the cursor one step back.
  */
 void lcd_back(void) {
-    lcd_goto(1 + (charCtr - 1) / 16, 1 + (charCtr - 1) % 16);
+    uint8_t const counter = lcd_console()->counter;
+    lcd_goto(1 + (counter - 1) / 16, 1 + (counter - 1) % 16);
 }
 
 /*!
  * Moves the cursor one step forward.
  */
 void lcd_forward(void) {
-    lcd_goto(1 + (charCtr + 1) / 16, 1 + (charCtr + 1) % 16);
+    uint8_t const counter = lcd_console()->counter;
+    lcd_goto(1 + (counter + 1) / 16, 1 + (counter + 1) % 16);
 }
 
 /*!
  * Moves the cursor to the first char
  */
 void lcd_home(void) {
-    lcd_goto(1 + charCtr / 16, 0);
+    lcd_goto(1 + lcd_console()->counter / 16, 0);
 }
 
 /*!
@@ -131,7 +228,8 @@ void lcd_home(void) {
  */
 void lcd_move(char row, char column) {
     // There are two rows
-    lcd_goto(1 + (2 + charCtr / 16 + row) % 2, 1 + (16 + charCtr + column) % 16);
+    uint8_t const counter = lcd_console()->counter;
+    lcd_goto(1 + (2 + counter / 16 + row) % 2, 1 + (16 + counter + column) % 16);
 }
 
 /*!
@@ -154,7 +252,7 @@ void lcd_goto(unsigned char row, unsigned char column) {
     char command = LCD_CURSOR_MOVE_R + column + row * LCD_NEXT_ROW;
 
     // Update char counter
-    charCtr = row * 16 + column;
+    lcd_console()->counter = row * 16 + column;
 
     lcd_command(command);
 }
@@ -231,17 +329,67 @@ void lcd_sendStream(uint8_t firstByte, uint8_t secondByte) {
  *  Sends a specific command to the LCD. This function is only used
  *  internally. There is no need to explicitly call it as its functionality is
  *  encapsulated within the other functions.
+ *  Commands of processes whose console is in the background are dropped.
  *
  *  \param command The command to be executed.
  *  \internal
  */
 void lcd_command(uint8_t command) {
+    if (lcd_visible()) {
+        lcd_panelCommand(command);
+    }
+}
+
+/*!
+ *  Sends a specific command to the LCD, no matter which console is shown.
+ *
+ *  \param command The command to be executed.
+ *  \internal
+ */
+static void lcd_panelCommand(uint8_t command) {
     lcd_sendStream((command >> 4) & 0xF, command & 0xF);
 }
 
+/*!
+ *  Writes a display code to the LCD and advances the cursor. A newline
+ *  moves to the next line, as do 16 characters.
+ *  \internal
+ *
+ *  \param code  The display code to be written.
+ */
+static void lcd_putCode(uint8_t code) {
+    ATOMIC {
+        LcdConsole *const console = lcd_console();
+
+        // Check if line shall be changed
+        if (code == '\n') {
+            console->counter = console->counter < 0x10 ? 0x10 : 0x20;
+        }
+        if (console->counter == 0x10) {
+            lcd_line2();
+        } else if (console->counter == 0x20) {
+            lcd_clear();
+            lcd_line1();
+        }
+
+        if (code == '\n') return;
+
+        // Only the console in the foreground reaches the LCD
+        console->text[console->counter] = code;
+        if (lcd_visible()) {
+            lcd_sendStream(0x10 | ((code & 0xF0) >> 4), 0x10 | (code & 0x0F));
+            panel[console->counter] = code;
+        }
+
+        // Update char counter ... Do not modulo it down! we need it to become 32
+        console->counter++;
+    }
+}
+
 /*!
  *  Writes an 8-Bit UTF-8-like-value to the LCD.
- *  Supports automatic line breaks.
+ *  Supports automatic line breaks. Code points the display lacks are shown
+ *  as a box (0xDB), the fallback tools/lcd_transcode.py uses as well.
  *
  *  \param character  The character to be written.
  */
@@ -252,6 +400,12 @@ void lcd_writeChar(char character) {
         static uint32_t codePoint = 0;
         static uint8_t expectedBytes = 0;
 
+        // ASCII is its own display code, except for the two characters the LCD lacks
+        if (!expectedBytes && character <= 0x7F && character != '\\' && character != '~') {
+            lcd_putCode(character);
+            return;
+        }
+
         // Handle UTF-8
         if (!expectedBytes) { // New code point
             codePoint = character;
@@ -276,19 +430,6 @@ void lcd_writeChar(char character) {
         // Don't print UTF-8 special bytes
         if (expectedBytes) return;
 
-        // Check if line shall be changed
-        if (codePoint == '\n') {
-            charCtr = charCtr < 0x10 ? 0x10 : 0x20;
-        }
-        if (charCtr == 0x10) {
-            lcd_line2();
-        } else if (charCtr == 0x20) {
-            lcd_clear();
-            lcd_line1();
-        }
-
-        if (codePoint == '\n') return;
-
         // A remapping from UTF-8 to LCD
         #define REMAP(UTF8, LCD) case UTF8: character = LCD; break
         switch (codePoint) {
@@ -316,14 +457,12 @@ void lcd_writeChar(char character) {
             REMAP(0xE2889A, 0xE8            ); // √
             REMAP(0xE296A1, 0xDB            ); // □
             REMAP(0xE296AE, 0xFF            ); // ▮
-            default: character = codePoint <= 0x7F ? codePoint : character; break;
+            // The display lacks the code point, it is shown as a box like an invalid byte
+            default: character = codePoint <= 0x7F ? codePoint : 0xDB; break;
         }
         #undef REMAP
 
-        lcd_sendStream(0x10 | ((character & 0xF0) >> 4), 0x10 | (character & 0x0F));
-
-        // Update char counter ... Do not modulo it down! we need it to become 32
-        charCtr++;
+        lcd_putCode(character);
     }
 }
 
@@ -331,7 +470,12 @@ void lcd_writeChar(char character) {
  *  Erases the LCD and positions the cursor at the top left corner.
  */
 void lcd_clear(void) {
-    charCtr = 0;
+    LcdConsole *const console = lcd_console();
+    memset(console->text, ' ', sizeof(console->text));
+    console->counter = 0;
+    if (lcd_visible()) {
+        memset(panel, ' ', sizeof(panel));
+    }
     lcd_command(LCD_CLEAR);
 }
 
@@ -341,7 +485,8 @@ void lcd_clear(void) {
  */
 void lcd_erase(uint8_t line) {
     // Save counter
-    uint8_t i = 0, oldCtr = charCtr;
+    LcdConsole *const console = lcd_console();
+    uint8_t i = 0, oldCtr = console->counter;
 
     // Restrict param to a valid value
     if (line > 2) {
@@ -357,10 +502,10 @@ void lcd_erase(uint8_t line) {
     }
 
     // Restore counter
-    charCtr = oldCtr;
+    console->counter = oldCtr;
 
     // Restore cursor
-    lcd_goto((charCtr / 16) + 1, (charCtr % 16) + 1);
+    lcd_goto((oldCtr / 16) + 1, (oldCtr % 16) + 1);
 }
 
 /*!
@@ -369,14 +514,7 @@ void lcd_erase(uint8_t line) {
  *  \param number  The number to be written.
  */
 void lcd_writeHexNibble(uint8_t number) {
-    // Get low and high nibble
-    uint8_t const low = number & 0xF;
-
-    if (low < 10) {
-        lcd_writeChar(low + '0'); // Write as ASCII number
-    } else {
-        lcd_writeChar(low - 10 + 'A'); // Write as ASCII letter
-    }
+    os_printHex(lcdout, number & 0xF, 1);
 }
 
 /*!
@@ -385,8 +523,7 @@ void lcd_writeHexNibble(uint8_t number) {
  *  \param number  The number to be written.
  */
 void lcd_writeHexByte(uint8_t number) {
-    lcd_writeHexNibble(number >> 4);
-    lcd_writeHexNibble(number & 0xF);
+    os_printHex(lcdout, number, 2);
 }
 
 /*!
@@ -395,8 +532,7 @@ void lcd_writeHexByte(uint8_t number) {
  *  \param number  The number to be written.
  */
 void lcd_writeHexWord(uint16_t number) {
-    lcd_writeHexByte(number >> 8);
-    lcd_writeHexByte(number);
+    os_printHex(lcdout, number, 4);
 }
 
 /*!
@@ -405,41 +541,14 @@ void lcd_writeHexWord(uint16_t number) {
  * \param number The number to be written.
  */
 void lcd_writeHex(uint16_t number) {
-    if (!number) {
-        lcd_writeChar('0');
-        return;
-    }
-
-    uint16_t nib = 16;
-    uint8_t print = 0;
-    // Iterate over all nibbles and start printing when we find the first non-zero
-    while (nib) {
-        nib -= 4;
-        print |= number >> nib;
-        if (print) {
-            lcd_writeHexNibble(number >> nib);
-        }
-    }
+    os_printHex(lcdout, number, 0);
 }
 
 /*!
  *  Writes a 16 bit integer as a decimal number without leading 0s
  */
 void lcd_writeDec(uint16_t number) {
-    if (!number) {
-        lcd_writeChar('0');
-        return;
-    }
-
-    uint32_t pos = 10000;
-    uint8_t print = 0;
-    do {
-        uint8_t const digit = number / pos;
-        number -= digit * pos;
-        if (print |= digit) {
-            lcd_writeChar(digit + '0');
-        }
-    } while (pos /= 10);
+    os_printUnsigned(lcdout, number, 0, ' ');
 }
 
 /*!
@@ -465,12 +574,29 @@ void lcd_writeString(char const* text) {
  */
 void lcd_drawBar(uint8_t percent) {
     lcd_clear();
-    // Calculate number of bars
-    uint16_t const val = ((percent <= 100) ? percent : 100) * 16;
-    uint16_t i = 0;
-    // Draw bars
-    for (i = 0; i < val; i += 100) {
-        lcd_writeProgString(PSTR("▮"));
+    lcd_writeBar(percent, 16);
+}
+
+/*!
+ *  Writes a horizontal bar graph at the cursor. Every character shows five
+ *  steps of the bar (one per pixel column), so the bar is five times finer
+ *  than with full blocks only.
+ *
+ *  \param percent Percent of the bar to be filled (at most 100)
+ *  \param width Number of characters the bar takes
+ */
+void lcd_writeBar(uint8_t percent, uint8_t width) {
+    uint16_t columns = ((uint16_t)(percent <= 100 ? percent : 100) * width * 5 + 50) / 100;
+    while (width--) {
+        if (columns >= 5) {
+            lcd_putCode(0xFF);
+            columns -= 5;
+        } else if (columns) {
+            lcd_putCode(LCD_CC_BAR(columns));
+            columns = 0;
+        } else {
+            lcd_putCode(' ');
+        }
     }
 }
 
@@ -494,6 +620,21 @@ void lcd_writeProgString(char const* string) {
     }
 }
 
+/*!
+ *  Writes a string of display codes from the program flash memory to the LCD.
+ *  Unlike lcd_writeProgString there is no UTF-8 decoding, every byte is sent
+ *  as it is (only '\n' breaks the line). Use it for strings that were
+ *  transcoded at compile time (see LCD_STR_DEGREE and tools/lcd_transcode.py).
+ *
+ *  \param string  The string to be written (a pointer to the first character).
+ */
+void lcd_writeCodeProgString(char const* string) {
+    uint8_t code;
+    while ((code = pgm_read_byte(string++))) {
+        lcd_putCode(code);
+    }
+}
+
 /*!
  *  Writes an error string of 8-Bit ASCII-values from the program flash memory to the LCD.
  *  For details see lcd_writeProgString.
@@ -501,7 +642,7 @@ void lcd_writeProgString(char const* string) {
  *  \param string  The string to be written (a pointer to the first character).
  */
 void lcd_writeErrorProgString(char const* string) {
-    fprintf_P(stderr, string);
+    os_printf_P(stderr, string);
 }
 
 /*!
@@ -514,7 +655,7 @@ void lcd_writeErrorProgString(char const* string) {
 void lcd_registerCustomChar(uint8_t addr, uint64_t chr) {
     uint8_t const sreg = SREG & (1 << 7);
     cli();
-    lcd_command(0x40 | (0x38 & (addr << 3)));
+    lcd_panelCommand(0x40 | (0x38 & (addr << 3)));
     _delay_us(40);
 
     uint8_t i = 8;
@@ -532,10 +673,8 @@ void lcd_registerCustomChar(uint8_t addr, uint64_t chr) {
 *  \param number is the number to write
 */
 void lcd_write32bitHex(uint32_t number) {
-    lcd_writeDec(0);
-    lcd_writeChar('x');
-    lcd_writeHexWord(number >> 16);
-    lcd_writeHexWord(number);
+    os_printProgString(lcdout, PSTR("0x"));
+    os_printHex(lcdout, number, 8);
 }
 
 /*! \brief Prints the passed voltage onto the display (three float places).
@@ -545,25 +684,204 @@ void lcd_write32bitHex(uint32_t number) {
  * \param voltUpperBound    Upper bound of the float voltage value (i.e. 5 for 5V).
  */
 void lcd_writeVoltage(uint16_t voltage, uint16_t valueUpperBound, uint8_t voltUpperBound) {
-    uint8_t  intVal;
-    uint16_t floatVal;
-
-    // Calculate integer and float part of the voltage
-    voltage *= voltUpperBound;
-    intVal   = voltage / valueUpperBound;
-    floatVal = (uint32_t)(voltage - (intVal * valueUpperBound)) * 1000 / valueUpperBound;
-
-    // Show voltage on display
-    lcd_writeDec(intVal);
-    lcd_writeChar('.');
-    if (floatVal < 100) {
-        lcd_writeChar('0');
+    // Scale to millivolts, the only division left is the one by the runtime bound
+    uint32_t const millivolts = (uint32_t)voltage * voltUpperBound * 1000 / valueUpperBound;
+
+    os_printFixed(lcdout, millivolts, 3);
+    lcd_writeChar('V');
+}
+
+/*!
+ *  Writes a console to the LCD and places the cursor where the console
+ *  continues.
+ *  \internal
+ *
+ *  \param index  The console to show.
+ */
+static void lcd_redraw(uint8_t index) {
+    ATOMIC {
+        lcd_trace(OS_TE_LCD_BEGIN);
+        LcdConsole const *const console = &consoles[index];
+        lcd_panelCommand(LCD_LINE_1);
+        for (uint8_t i = 0; i < 32; i++) {
+            if (i == 16) {
+                lcd_panelCommand(LCD_LINE_2);
+            }
+            char const character = console->text[i];
+            lcd_sendStream(0x10 | ((character & 0xF0) >> 4), 0x10 | (character & 0x0F));
+        }
+        memcpy(panel, console->text, sizeof(panel));
+        uint8_t const position = console->counter % 32;
+        lcd_panelCommand(LCD_CURSOR_MOVE_R + position % 16 + (position / 16) * LCD_NEXT_ROW);
+        lcd_trace(OS_TE_LCD_END);
+    }
+}
+
+/*!
+ *  Sends the characters of a console that differ from what the LCD shows and
+ *  places the cursor where the console continues.
+ *  \internal
+ *
+ *  \param index  The console to show.
+ */
+static void lcd_flush(uint8_t index) {
+    ATOMIC {
+        lcd_trace(OS_TE_LCD_BEGIN);
+        LcdConsole const *const console = &consoles[index];
+        // Position the address counter of the LCD points to, 0xFF if unknown
+        uint8_t cursor = 0xFF;
+        for (uint8_t i = 0; i < 32; i++) {
+            char const character = console->text[i];
+            if (character == panel[i]) {
+                continue;
+            }
+            if (i != cursor) {
+                lcd_panelCommand(LCD_CURSOR_MOVE_R + i % 16 + (i / 16) * LCD_NEXT_ROW);
+            }
+            lcd_sendStream(0x10 | ((character & 0xF0) >> 4), 0x10 | (character & 0x0F));
+            panel[i] = character;
+            // The address counter does not wrap from the end of line 1 to line 2
+            cursor = i == 15 ? 0xFF : i + 1;
+        }
+        uint8_t const position = console->counter % 32;
+        lcd_panelCommand(LCD_CURSOR_MOVE_R + position % 16 + (position / 16) * LCD_NEXT_ROW);
+        lcd_trace(OS_TE_LCD_END);
     }
-    if (floatVal < 10) {
-        lcd_writeChar('0');
+}
+
+/*!
+ *  Gives the calling process its own virtual console. From then on its output
+ *  only reaches the LCD while its console is in the foreground, so it neither
+ *  disturbs other processes nor waits for the LCD otherwise.
+ *
+ *  \return True, iff the calling process got a console (the idle process
+ *          always writes to the shared console).
+ */
+bool lcd_openConsole(void) {
+#if SPOS_CONFIG
+    ProcessID const pid = os_getCurrentProc();
+    if (pid == 0 || pid >= LCD_CONSOLES) {
+        return false;
+    }
+
+    ATOMIC {
+        memset(consoles[pid].text, ' ', sizeof(consoles[pid].text));
+        consoles[pid].counter = 0;
+        consoles[pid].framed = false;
+        consoleOwners |= 1 << pid;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*!
+ *  Takes the console of a process away, so it writes to the shared console
+ *  again. Called when a process slot is reused.
+ *
+ *  \param pid  The process whose console is closed.
+ */
+void lcd_closeConsole(uint8_t pid) {
+    if (pid == 0 || pid >= LCD_CONSOLES) {
+        return;
+    }
+
+    ATOMIC {
+        consoleOwners &= ~(1 << pid);
+        if (foreground == pid) {
+            lcd_showConsole(0);
+        }
+    }
+}
+
+/*!
+ *  Brings a console to the foreground and shows its content on the LCD.
+ *
+ *  \param console  The console to show (0 is the shared console, otherwise
+ *                  the id of a process that opened a console).
+ */
+void lcd_showConsole(uint8_t console) {
+    if (console >= LCD_CONSOLES || (console && !(consoleOwners & (1 << console)))) {
+        return;
+    }
+
+    ATOMIC {
+        foreground = console;
+        if (!directDepth) {
+            lcd_redraw(foreground);
+        }
+    }
+}
+
+/*!
+ *  Brings the next console to the foreground, cycling through the shared
+ *  console and the consoles of all processes that opened one.
+ */
+void lcd_switchConsole(void) {
+    uint8_t next = foreground;
+    do {
+        next = (next + 1) % LCD_CONSOLES;
+    } while (next && !(consoleOwners & (1 << next)));
+    lcd_showConsole(next);
+}
+
+/*!
+ *  A simple getter for the console in the foreground.
+ *
+ *  \return The console shown on the LCD
+ */
+uint8_t lcd_getForegroundConsole(void) {
+    return foreground;
+}
+
+/*!
+ *  Bypasses the consoles: until lcd_endDirect, all output goes to the LCD,
+ *  no matter which process writes it. Used by the task manager and for
+ *  errors, which have to be seen right away. Calls may be nested.
+ */
+void lcd_beginDirect(void) {
+    ATOMIC {
+        directDepth++;
+    }
+}
+
+/*!
+ *  Ends the bypass started by lcd_beginDirect. When the outermost bypass
+ *  ends, the console in the foreground is shown again.
+ */
+void lcd_endDirect(void) {
+    ATOMIC {
+        if (directDepth && !--directDepth) {
+            lcd_redraw(foreground);
+        }
+    }
+}
+
+/*!
+ *  Starts drawing a frame: until lcd_endFrame, the output of the calling
+ *  process only goes to its console. Pages that are redrawn from scratch
+ *  (lcd_clear and then everything) use this to avoid flicker and to not
+ *  send characters that did not change.
+ */
+void lcd_beginFrame(void) {
+    ATOMIC {
+        lcd_console()->framed = true;
+    }
+}
+
+/*!
+ *  Ends a frame started with lcd_beginFrame and sends the characters that
+ *  changed since the LCD was written last, if the console is shown.
+ */
+void lcd_endFrame(void) {
+    ATOMIC {
+        uint8_t const index = lcd_consoleIndex();
+        consoles[index].framed = false;
+        if (lcd_visible()) {
+            lcd_flush(index);
+        }
     }
-    lcd_writeDec(floatVal);
-    lcd_writeChar('V');
 }
 
 #pragma GCC pop_options
\ No newline at end of file
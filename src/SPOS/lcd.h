@@ -181,6 +181,38 @@
     0x08, \
     0x00))
 
+// Custom chars 4 to 7 are bars of 1 to 4 columns (see lcd_writeBar)
+#define LCD_CC_BAR(COLUMNS) (3 + (COLUMNS))
+#define LCD_CC_BAR_BITMAP(COLUMNS) (CUSTOM_CHAR( \
+    0x00, \
+    (0x1F << (5 - (COLUMNS))) & 0x1F, \
+    (0x1F << (5 - (COLUMNS))) & 0x1F, \
+    (0x1F << (5 - (COLUMNS))) & 0x1F, \
+    (0x1F << (5 - (COLUMNS))) & 0x1F, \
+    (0x1F << (5 - (COLUMNS))) & 0x1F, \
+    (0x1F << (5 - (COLUMNS))) & 0x1F, \
+    0x00))
+
+//----------------------------------------------------------------------------
+// Display codes
+//----------------------------------------------------------------------------
+
+/*
+ *  String literals holding the display code of characters beyond ASCII, to
+ *  build pre-transcoded strings for lcd_writeCodeProgString at compile time,
+ *  e.g. PSTR("20" LCD_STR_DEGREE "C"). tools/lcd_transcode.py converts whole
+ *  UTF-8 strings. Custom char 0 is written through its mirror 8.
+ */
+#define LCD_STR_IXI         "\x08"
+#define LCD_STR_TILDE       "\x01"
+#define LCD_STR_BACKSLASH   "\x02"
+#define LCD_STR_MU          "\x03"
+#define LCD_STR_ARROW_RIGHT "\x7E"
+#define LCD_STR_ARROW_LEFT  "\x7F"
+#define LCD_STR_DEGREE      "\xDF"
+#define LCD_STR_BOX         "\xDB"
+#define LCD_STR_BAR         "\xFF"
+
 //----------------------------------------------------------------------------
 // Function headers and global variables
 //----------------------------------------------------------------------------
@@ -248,6 +280,12 @@ void lcd_writeProgString(const char* string);
 //! Write char PROGMEM* string as an error
 void lcd_writeErrorProgString(const char* string);
 
+//! Writes a bar graph of the given width at the cursor
+void lcd_writeBar(uint8_t percent, uint8_t width);
+
+//! Writes a string of display codes from program memory without UTF-8 decoding
+void lcd_writeCodeProgString(const char* string);
+
 //! Write a draw bar
 void lcd_drawBar(uint8_t percent);
 
@@ -260,5 +298,36 @@ void lcd_write32bitHex(uint32_t number);
 //! Write a voltage with valueUpperBound as float voltage with voltUpperBound
 void lcd_writeVoltage(uint16_t voltage, uint16_t valueUpperBound, uint8_t voltUpperBound);
 
+//----------------------------------------------------------------------------
+// Virtual consoles
+//----------------------------------------------------------------------------
+
+//! Gives the calling process its own virtual console
+bool lcd_openConsole(void);
+
+//! Lets a process write to the shared console again
+void lcd_closeConsole(uint8_t pid);
+
+//! Shows a console on the LCD
+void lcd_showConsole(uint8_t console);
+
+//! Shows the next console on the LCD
+void lcd_switchConsole(void);
+
+//! Returns the console shown on the LCD
+uint8_t lcd_getForegroundConsole(void);
+
+//! Writes directly to the LCD, bypassing the consoles
+void lcd_beginDirect(void);
+
+//! Ends writing directly to the LCD and shows the foreground console again
+void lcd_endDirect(void);
+
+//! Following output of the calling process only goes to its console
+void lcd_beginFrame(void);
+
+//! Sends what changed on the console of the calling process since lcd_beginFrame
+void lcd_endFrame(void);
+
 #endif
 
@@ -1,19 +1,52 @@
 #include "os_core.h"
 
 #include <avr/interrupt.h>
+#include <avr/power.h>
+#include <avr/sleep.h>
 #include <avr/wdt.h>
 #include <stdio.h>
 
 #include "defines.h"
 #include "lcd.h"
 #include "os_input.h"
+#include "os_io.h"
+#include "os_pipe.h"
+#include "os_scheduler.h"
+#include "os_stats.h"
+#include "os_trace.h"
+#include "os_usart.h"
 #include "util.h"
-
-void os_initScheduler(void);
+#if (VERSUCH >= 3)
+    #include "os_memheap_drivers.h"
+#endif
 
 // variable for saving the original MCUSR so that we can examine it later
 uint8_t savedMCUSR __attribute__((section(".noinit")));
 
+//! Prescalers of timer 2, indexed by their clock select bits (CS22:0) minus one
+static uint16_t const tickPrescalers[] PROGMEM = {1, 8, 32, 64, 128, 256, 1024};
+
+//! Number of selectable prescalers of timer 2
+#define TICK_PRESCALER_COUNT (sizeof(tickPrescalers) / sizeof(tickPrescalers[0]))
+
+//! Clock select bits of timer 2
+#define TICK_CLOCK_SELECT_MASK (_BV(CS22) | _BV(CS21) | _BV(CS20))
+
+//! Configured period of the scheduler tick in microseconds
+static uint16_t tickPeriod;
+
+//! Prescaler of timer 2 for the configured tick period
+static uint16_t tickPrescaler;
+
+//! Compare value of timer 2 for the configured tick period
+static uint8_t tickCompare;
+
+//! Current division of the system clock
+static clock_div_t clockDivision = clock_div_1;
+
+//! Whether the clock governor adapts the clock division
+static bool clockGovernor = DEFAULT_CLOCK_GOVERNOR;
+
 /*! \file
  *
  * The main system core with initialization functions and error handling.
@@ -88,11 +121,8 @@ void os_init_timer(void) {
     // Init timer 2 (Scheduler)
     sbi(TCCR2A, WGM21);  // Clear on timer compare match
 
-    sbi(TCCR2B, CS22);    // Prescaler 1024  1
-    sbi(TCCR2B, CS21);    // Prescaler 1024  1
-    sbi(TCCR2B, CS20);    // Prescaler 1024  1
+    os_setTickPeriod(DEFAULT_TICK_PERIOD);  // Prescaler and compare value
     sbi(TIMSK2, OCIE2A);  // Enable interrupt
-    OCR2A = 60;
 
     // Init timer 0 with prescaler 256
     cbi(TCCR0B, CS00);
@@ -102,11 +132,217 @@ void os_init_timer(void) {
     sbi(TIMSK0, TOIE0);
 }
 
+/*!
+ *  Converts a period to timer 2 counts at the given prescaler and the current
+ *  clock division.
+ *
+ *  \param microseconds  The period to convert
+ *  \param prescaler  The prescaler of timer 2
+ *  \return The rounded number of timer counts
+ */
+static uint32_t os_tickCounts(uint16_t microseconds, uint16_t prescaler) {
+    uint32_t const cyclesPerPeriod = ((uint32_t)microseconds * (F_CPU / 1000000UL)) >> clockDivision;
+    return (cyclesPerPeriod + prescaler / 2) / prescaler;
+}
+
+/*!
+ *  Sets the period of the scheduler tick. The smallest prescaler of timer 2
+ *  that can count the whole period is chosen, as it gives the finest
+ *  resolution. The counter is restarted if it already passed the new compare
+ *  value, so the next tick is never delayed by a full timer overflow.
+ *  Processes with their own quantum (see os_setProcessTickPeriod) are
+ *  converted to the new prescaler as well.
+ *
+ *  \param microseconds  The new tick period, at least MIN_TICK_PERIOD and at
+ *                       most 256 counts of timer 2 at prescaler 1024
+ *                       (13107 at 20 MHz)
+ *  \return True, iff the period could be configured
+ */
+bool os_setTickPeriod(uint16_t microseconds) {
+    if (microseconds < MIN_TICK_PERIOD) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < TICK_PRESCALER_COUNT; i++) {
+        uint16_t const prescaler = pgm_read_word(&tickPrescalers[i]);
+        uint32_t const counts = os_tickCounts(microseconds, prescaler);
+        if (counts > 256) {
+            continue;
+        }
+        if (counts == 0) {
+            // Too short for the divided clock
+            break;
+        }
+
+        os_enterCriticalSection();
+        tickPeriod = microseconds;
+        tickPrescaler = prescaler;
+        tickCompare = counts - 1;
+        TCCR2B = (TCCR2B & ~TICK_CLOCK_SELECT_MASK) | (i + 1);
+        OCR2A = tickCompare;
+        if (TCNT2 >= tickCompare) {
+            TCNT2 = 0;
+        }
+        os_refreshProcessTickPeriods();
+        os_leaveCriticalSection();
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+ *  A simple getter for the period of the scheduler tick.
+ *
+ *  \return The tick period in microseconds
+ */
+uint16_t os_getTickPeriod(void) {
+    return tickPeriod;
+}
+
+/*!
+ *  A simple getter for the prescaler of timer 2.
+ *
+ *  \return The number of clock cycles per count of timer 2
+ */
+uint16_t os_getTickPrescaler(void) {
+    return tickPrescaler;
+}
+
+/*!
+ *  Converts a period to a compare value of timer 2 at the prescaler of the
+ *  current tick period. Periods that do not fit are clamped to the shortest or
+ *  longest period possible at that prescaler.
+ *
+ *  \param microseconds  The period to convert, 0 meaning the tick period itself
+ *  \return The value for OCR2A
+ */
+uint8_t os_getTickCompare(uint16_t microseconds) {
+    if (microseconds == 0) {
+        return tickCompare;
+    }
+
+    uint32_t const counts = os_tickCounts(microseconds, tickPrescaler);
+    if (counts == 0) {
+        return 0;
+    }
+    return counts > 256 ? 255 : counts - 1;
+}
+
+/*!
+ *  Powers down every peripheral except the timers the OS runs on. Drivers
+ *  power up the peripherals they need when they are initialized (e.g.
+ *  power_usart0_enable()), so anything no driver asked for stays off. The
+ *  analog comparator is not covered by PRR and is switched off separately.
+ */
+void os_initPower(void) {
+    power_all_disable();
+    power_timer0_enable();  // System time
+    power_timer2_enable();  // Scheduler
+    sbi(ACSR, ACD);
+}
+
+/*!
+ *  Determines the deepest sleep mode the idle process may enter without
+ *  missing a wake-up. Power-save mode only keeps timer 2 running, and only if
+ *  it is clocked asynchronously. So it is chosen only if timer 2 runs from
+ *  its own oscillator and all other peripherals are powered down. Otherwise
+ *  the idle mode keeps the peripheral clocks running.
+ *
+ *  \return The sleep mode for set_sleep_mode()
+ */
+uint8_t os_getIdleSleepMode(void) {
+    uint8_t const othersPowered = ~PRR & ~_BV(PRTIM2) & OS_PRR_MASK;
+    if (gbi(ASSR, AS2) && !othersPowered) {
+        return SLEEP_MODE_PWR_SAVE;
+    }
+    return SLEEP_MODE_IDLE;
+}
+
+/*!
+ *  Divides the system clock through CLKPR. Timer 0 and timer 2 then count
+ *  slower, so the system time is folded into a base first and the scheduler
+ *  tick and the baud rate are reconfigured for the new clock. Delays built
+ *  on the compile-time F_CPU (e.g. _delay_us of the LCD) only get longer.
+ *
+ *  \param division The new division of the system clock
+ */
+void os_setClockDivision(clock_div_t division) {
+    uint8_t const sreg = SREG;
+    cli();
+    if (division != clockDivision) {
+        os_systemTime_rescale(division);
+        clock_prescale_set(division);
+        clockDivision = division;
+        os_setTickPeriod(tickPeriod);
+        os_refreshUsartBaudRate();
+    }
+    SREG = sreg;
+}
+
+/*!
+ *  A simple getter for the division of the system clock.
+ *
+ *  \return The current clock division
+ */
+clock_div_t os_getClockDivision(void) {
+    return clockDivision;
+}
+
+/*!
+ *  Enables or disables the clock governor. Disabling it restores the full
+ *  clock.
+ *
+ *  \param enabled Whether the governor may divide the clock
+ */
+void os_setClockGovernor(bool enabled) {
+    clockGovernor = enabled;
+    if (!enabled) {
+        os_setClockDivision(clock_div_1);
+    }
+}
+
+/*!
+ *  Doubles the clock if the processor is busy and halves it (down to
+ *  GOVERNOR_MAX_DIVISION) if it is mostly idle. The thresholds are far enough
+ *  apart that halving the clock does not immediately lead to doubling it
+ *  again. Called once per sample period of the CPU utilization.
+ *
+ *  \param utilization The CPU utilization in percent
+ */
+void os_governClock(uint8_t utilization) {
+    if (!clockGovernor) {
+        return;
+    }
+
+    if (utilization >= GOVERNOR_UP_THRESHOLD && clockDivision > clock_div_1) {
+        os_setClockDivision(clockDivision - 1);
+    } else if (utilization < GOVERNOR_DOWN_THRESHOLD && clockDivision < GOVERNOR_MAX_DIVISION) {
+        os_setClockDivision(clockDivision + 1);
+    }
+}
+
+/*!
+ *  Restores the full clock right away when a process with a priority of at
+ *  least GOVERNOR_BOOST_PRIORITY becomes ready, so it does not have to wait
+ *  for the governor to notice the load.
+ *
+ *  \param priority The priority of the process that became ready
+ */
+void os_boostClock(Priority priority) {
+    if (clockGovernor && priority >= GOVERNOR_BOOST_PRIORITY) {
+        os_setClockDivision(clock_div_1);
+    }
+}
+
 /*!
  *  Readies stack, scheduler and heap for first use. Additionally, the LCD is initialized. In order to do those tasks,
  *  it calls the sub function os_initScheduler().
  */
 void os_init(void) {
+    // Power down unused peripherals
+    os_initPower();
+
     // Init timer 0 and 2
     os_init_timer();
 
@@ -115,16 +351,23 @@ void os_init(void) {
 
     // Init LCD display
     lcd_init();
-    stdout = lcdout;
-    stderr = lcdout;
+    os_initIO();
+    os_initPipes();
 
     lcd_writeProgString(PSTR("Booting SPOS ..."));
     os_checkResetSource(OS_ALLOWED_RESET_SOURCES);
     delayMs(DEFAULT_OUTPUT_DELAY * 20);
 
+#if (VERSUCH >= 3)
+    // Autostarted programs may allocate right away
+    os_initMemDrivers();
+    os_initHeaps();
+#endif
     os_initScheduler();
 
     os_systemTime_reset();
+    os_initStats();
+    os_initTrace();
 }
 
 /*!
@@ -139,12 +382,14 @@ void os_errorPStr(char const *str) {
     const uint8_t ENTER_bit = 0b00000001;
     const uint8_t ESC_bit = 0b00000010;
 
+    lcd_beginDirect();
     lcd_clear();
     lcd_writeErrorProgString(str);
 
     os_waitForCertainInput(ENTER_bit | ESC_bit);
 
     os_waitForNoInput();
+    lcd_endDirect();
     os_enableGlobalInterrupts();
 }
 
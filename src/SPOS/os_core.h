@@ -12,10 +12,18 @@
 #define _OS_CORE_H
 
 #include <avr/pgmspace.h>
+#include <avr/power.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "os_process.h"
 
 //! Allowed reset sources that are not considered erroneous resetting of the MCU
 #define OS_ALLOWED_RESET_SOURCES (_BV(JTRF) | _BV(BORF) | _BV(EXTRF) | _BV(PORF))
 
+//! All bits of the power reduction register that gate a peripheral
+#define OS_PRR_MASK (_BV(PRTWI) | _BV(PRTIM2) | _BV(PRTIM0) | _BV(PRTIM1) | _BV(PRSPI) | _BV(PRUSART0) | _BV(PRADC))
+
 //! Handy define to specify error messages directly
 #define os_error(str) os_errorPStr(PSTR(str))
 
@@ -26,6 +34,39 @@
 //! Initializes timers
 void os_init_timer(void);
 
+//! Powers down all peripherals the OS does not use
+void os_initPower(void);
+
+//! Determines the deepest sleep mode that keeps all wake-up sources working
+uint8_t os_getIdleSleepMode(void);
+
+//! Divides the system clock while keeping the system time and the tick period
+void os_setClockDivision(clock_div_t division);
+
+//! Returns the current division of the system clock
+clock_div_t os_getClockDivision(void);
+
+//! Enables or disables the clock governor
+void os_setClockGovernor(bool enabled);
+
+//! Lets the clock governor adapt the clock to the measured CPU utilization
+void os_governClock(uint8_t utilization);
+
+//! Restores the full clock if a process of the given priority becomes ready
+void os_boostClock(Priority priority);
+
+//! Sets the period of the scheduler tick in microseconds
+bool os_setTickPeriod(uint16_t microseconds);
+
+//! Returns the period of the scheduler tick in microseconds
+uint16_t os_getTickPeriod(void);
+
+//! Returns the prescaler of timer 2 for the scheduler tick
+uint16_t os_getTickPrescaler(void);
+
+//! Converts a period in microseconds to a compare value of timer 2 at its current prescaler
+uint8_t os_getTickCompare(uint16_t microseconds);
+
 //! Examines the saved MCU status register and possibly prints an error if the reset source is not allowed
 void os_checkResetSource(uint8_t allowedSources);
 
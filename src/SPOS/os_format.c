@@ -0,0 +1,271 @@
+/*! \file
+ *  \brief Compact number formatting for any output stream.
+ *
+ *  Binary numbers are converted to decimal with the double dabble algorithm,
+ *  which only needs shifts and additions: the AVR has no divider and a 32 bit
+ *  division by ten costs hundreds of cycles per digit. Since everything is
+ *  written through a FILE, the same code serves the LCD, pipes and the USART.
+ */
+
+#include "os_format.h"
+
+#include <avr/pgmspace.h>
+#include <stdarg.h>
+#include <stdbool.h>
+
+//----------------------------------------------------------------------------
+// Private constants
+//----------------------------------------------------------------------------
+
+//! Number of decimal digits of the largest uint32_t
+#define MAX_DECIMAL_DIGITS 10
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Converts a number to decimal digits with double dabble: the bits are
+ *  shifted into a packed BCD register one at a time, and every BCD digit
+ *  that would overflow when doubled (i.e. is at least 5) is corrected by 3
+ *  beforehand.
+ *
+ *  \param number The number to convert.
+ *  \param digits Receives the digits, most significant first (no leading zeros).
+ *  \return The number of digits (at least 1).
+ */
+static uint8_t os_toDecimal(uint32_t number, char digits[MAX_DECIMAL_DIGITS]) {
+    uint8_t bcd[MAX_DECIMAL_DIGITS / 2] = {0};
+
+    // Leading zero bits do not change the BCD register
+    uint8_t bits = 32;
+    while (bits && !(number & 0x80000000UL)) {
+        number <<= 1;
+        bits--;
+    }
+
+    while (bits--) {
+        for (uint8_t i = 0; i < sizeof(bcd); i++) {
+            uint8_t byte = bcd[i];
+            if ((byte & 0x0F) >= 0x05) {
+                byte += 0x03;
+            }
+            if ((byte & 0xF0) >= 0x50) {
+                byte += 0x30;
+            }
+            bcd[i] = byte;
+        }
+        uint8_t carry = number >> 31;
+        number <<= 1;
+        for (uint8_t i = 0; i < sizeof(bcd); i++) {
+            uint8_t const next = bcd[i] >> 7;
+            bcd[i] = (bcd[i] << 1) | carry;
+            carry = next;
+        }
+    }
+
+    uint8_t count = 0;
+    for (uint8_t i = MAX_DECIMAL_DIGITS; i--;) {
+        uint8_t const digit = (i & 1) ? bcd[i / 2] >> 4 : bcd[i / 2] & 0x0F;
+        if (count || digit || !i) {
+            digits[count++] = digit + '0';
+        }
+    }
+    return count;
+}
+
+/*!
+ *  Writes a character repeatedly.
+ *
+ *  \param stream The stream to write to.
+ *  \param c The character to write.
+ *  \param count How often to write it.
+ */
+static void os_printRepeated(FILE *stream, char c, uint8_t count) {
+    while (count--) {
+        fputc(c, stream);
+    }
+}
+
+/*!
+ *  Writes an unsigned decimal number.
+ *
+ *  \param stream The stream to write to.
+ *  \param number The number to write.
+ *  \param width Minimum number of characters to write.
+ *  \param pad The character to fill up to the width with (usually ' ' or '0').
+ */
+void os_printUnsigned(FILE *stream, uint32_t number, uint8_t width, char pad) {
+    char digits[MAX_DECIMAL_DIGITS];
+    uint8_t const count = os_toDecimal(number, digits);
+    if (width > count) {
+        os_printRepeated(stream, pad, width - count);
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        fputc(digits[i], stream);
+    }
+}
+
+/*!
+ *  Writes a signed decimal number. With '0' as padding the sign precedes
+ *  the zeros, otherwise the padding.
+ *
+ *  \param stream The stream to write to.
+ *  \param number The number to write.
+ *  \param width Minimum number of characters to write (including the sign).
+ *  \param pad The character to fill up to the width with (usually ' ' or '0').
+ */
+void os_printSigned(FILE *stream, int32_t number, uint8_t width, char pad) {
+    if (number >= 0) {
+        os_printUnsigned(stream, number, width, pad);
+        return;
+    }
+
+    char digits[MAX_DECIMAL_DIGITS];
+    uint8_t const count = os_toDecimal(-(uint32_t)number, digits);
+    uint8_t const padding = width > count + 1 ? width - count - 1 : 0;
+    if (pad != '0') {
+        os_printRepeated(stream, pad, padding);
+    }
+    fputc('-', stream);
+    if (pad == '0') {
+        os_printRepeated(stream, pad, padding);
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        fputc(digits[i], stream);
+    }
+}
+
+/*!
+ *  Writes a decimal fixed-point number, e.g. 1234 with 3 decimals as 1.234
+ *  and 5 with 3 decimals as 0.005.
+ *
+ *  \param stream The stream to write to.
+ *  \param number The number scaled by 10^decimals.
+ *  \param decimals The number of fractional digits (0 writes an integer).
+ */
+void os_printFixed(FILE *stream, uint32_t number, uint8_t decimals) {
+    char digits[MAX_DECIMAL_DIGITS];
+    uint8_t const count = os_toDecimal(number, digits);
+    // Leading zeros so there is at least one integer digit
+    uint8_t const zeros = count > decimals ? 0 : decimals - count + 1;
+
+    uint8_t const total = zeros + count;
+    for (uint8_t i = 0; i < total; i++) {
+        if (decimals && total - i == decimals) {
+            fputc('.', stream);
+        }
+        fputc(i < zeros ? '0' : digits[i - zeros], stream);
+    }
+}
+
+/*!
+ *  Writes a hexadecimal number with uppercase letters.
+ *
+ *  \param stream The stream to write to.
+ *  \param number The number to write.
+ *  \param digits Number of digits to write including leading zeros (at most
+ *                8), or 0 to write the number without leading zeros.
+ */
+void os_printHex(FILE *stream, uint32_t number, uint8_t digits) {
+    bool leading = !digits;
+    if (!digits || digits > 8) {
+        digits = 8;
+    }
+
+    number <<= 32 - 4 * digits;
+    while (digits--) {
+        uint8_t const nibble = number >> 28;
+        number <<= 4;
+        // Skip leading zeros, but always write the last digit
+        if (leading && !nibble && digits) {
+            continue;
+        }
+        leading = false;
+        fputc(nibble < 10 ? nibble + '0' : nibble - 10 + 'A', stream);
+    }
+}
+
+/*!
+ *  Writes a null-terminated string from flash.
+ *
+ *  \param stream The stream to write to.
+ *  \param string The string (flash address of the first character).
+ */
+void os_printProgString(FILE *stream, char const *string) {
+    char c;
+    while ((c = (char)pgm_read_byte(string++))) {
+        fputc(c, stream);
+    }
+}
+
+/*!
+ *  A small printf with the format string in flash. Supported conversions:
+ *  %d, %i, %u, %x, %X (the latter two both uppercase) with an optional l
+ *  modifier for 32 bit arguments, %c, %s (RAM string), %S (flash string) and
+ *  %%. A width with an optional leading 0 may precede the conversion; for
+ *  %x and %X a 0-padded width is the number of hex digits.
+ *
+ *  \param stream The stream to write to.
+ *  \param format The format string (flash address of the first character).
+ */
+void os_printf_P(FILE *stream, char const *format, ...) {
+    va_list args;
+    va_start(args, format);
+
+    char c;
+    while ((c = (char)pgm_read_byte(format++))) {
+        if (c != '%') {
+            fputc(c, stream);
+            continue;
+        }
+
+        c = (char)pgm_read_byte(format++);
+        char pad = ' ';
+        if (c == '0') {
+            pad = '0';
+            c = (char)pgm_read_byte(format++);
+        }
+        uint8_t width = 0;
+        while (c >= '0' && c <= '9') {
+            width = (width << 3) + (width << 1) + (c - '0');
+            c = (char)pgm_read_byte(format++);
+        }
+        bool const wide = c == 'l';
+        if (wide) {
+            c = (char)pgm_read_byte(format++);
+        }
+
+        switch (c) {
+            case 'd':
+            case 'i':
+                os_printSigned(stream, wide ? va_arg(args, int32_t) : va_arg(args, int), width, pad);
+                break;
+            case 'u':
+                os_printUnsigned(stream, wide ? va_arg(args, uint32_t) : va_arg(args, unsigned), width, pad);
+                break;
+            case 'x':
+            case 'X':
+                os_printHex(stream, wide ? va_arg(args, uint32_t) : va_arg(args, unsigned), pad == '0' ? width : 0);
+                break;
+            case 'c':
+                fputc(va_arg(args, int), stream);
+                break;
+            case 's':
+                fputs(va_arg(args, char const *), stream);
+                break;
+            case 'S':
+                os_printProgString(stream, va_arg(args, char const *));
+                break;
+            case '\0':
+                // Format ends with a lone %
+                va_end(args);
+                return;
+            default:
+                fputc(c, stream);
+                break;
+        }
+    }
+
+    va_end(args);
+}
@@ -0,0 +1,37 @@
+/*! \file
+ *  \brief Compact number formatting for any output stream.
+ *
+ *  Contains a small replacement for vfprintf that covers the conversions the
+ *  OS needs: integers, hexadecimal numbers, decimal fixed-point numbers and
+ *  strings from RAM and flash. Decimal conversion is done without division.
+ */
+
+#ifndef _OS_FORMAT_H
+#define _OS_FORMAT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Writes an unsigned decimal number, padded to the given width
+void os_printUnsigned(FILE *stream, uint32_t number, uint8_t width, char pad);
+
+//! Writes a signed decimal number, padded to the given width
+void os_printSigned(FILE *stream, int32_t number, uint8_t width, char pad);
+
+//! Writes a decimal fixed-point number whose last digits are the fraction
+void os_printFixed(FILE *stream, uint32_t number, uint8_t decimals);
+
+//! Writes a hexadecimal number with the given number of digits (0 = no leading zeros)
+void os_printHex(FILE *stream, uint32_t number, uint8_t digits);
+
+//! Writes a string from flash
+void os_printProgString(FILE *stream, char const *string);
+
+//! printf-like output with a format string from flash, see the implementation for the supported conversions
+void os_printf_P(FILE *stream, char const *format, ...);
+
+#endif
@@ -0,0 +1,327 @@
+/*! \file
+ *  \brief Movable heap allocations.
+ *
+ *  Movable allocations are ordinary allocations of os_memory, owned by the
+ *  process that requested them, plus an entry in a handle table that keeps
+ *  their current address and how often they are locked. The compactor walks
+ *  a heap from its start: it takes the first free chunk and moves the
+ *  allocation behind the free run down to it, unless that allocation is
+ *  locked or was allocated with os_malloc.
+ *
+ *  An allocation is moved over several steps, each copying at most
+ *  COMPACTION_CHUNKS chunks within a critical section, so the compactor only
+ *  holds up the other processes for the time a few chunks take, however
+ *  large the allocation is. When a move starts, the allocation is extended
+ *  down over the free run in the map, so the chunks it is moved to and from
+ *  cannot be taken meanwhile, and its handle already refers to the new
+ *  start. Once all chunks are copied, the chunks behind it are freed. If
+ *  the owner locks the handle in between, os_lockHandle finishes the move.
+ */
+
+#include "os_handles.h"
+
+#include "os_core.h"
+#include "os_scheduler.h"
+
+//----------------------------------------------------------------------------
+// Private types
+//----------------------------------------------------------------------------
+
+//! A movable allocation
+typedef struct MovableBlock {
+    //! The heap of the allocation, NULL if the handle is unused
+    Heap *heap;
+
+    //! The current first chunk of the allocation
+    MemAddr addr;
+
+    //! The process that allocated it
+    ProcessID owner;
+
+    //! How often the allocation is locked, it is only moved if 0
+    uint8_t locks;
+} MovableBlock;
+
+//! A move of an allocation that is done a few chunks per step
+typedef struct Move {
+    //! The allocation being moved, NULL if there is no move
+    MovableBlock *block;
+
+    //! The old first chunk of the allocation
+    MemAddr from;
+
+    //! The size of the allocation in chunks
+    uint16_t size;
+
+    //! The number of chunks copied so far
+    uint16_t copied;
+} Move;
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! The handle table
+static MovableBlock blocks[MAX_NUMBER_OF_HANDLES];
+
+//! The move in progress, at most one at a time
+static Move move;
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Looks up a handle of the calling process. Must be called within a
+ *  critical section.
+ *
+ *  \param handle The handle.
+ *  \return The movable allocation or NULL (after an error) if the handle is
+ *          not in use or belongs to another process.
+ */
+static MovableBlock *os_getBlock(MemHandle handle) {
+    if (handle >= MAX_NUMBER_OF_HANDLES || !blocks[handle].heap) {
+        os_error("Invalid handle");
+        return NULL;
+    }
+    if (blocks[handle].owner != os_getCurrentProc()) {
+        os_error("Foreign handle");
+        return NULL;
+    }
+    return &blocks[handle];
+}
+
+/*!
+ *  Copies chunks of the allocation being moved. Once all are copied, the
+ *  chunks behind its new end are freed and the move is over. Must be called
+ *  within a critical section while there is a move.
+ *
+ *  \param chunks The maximum number of chunks to copy.
+ */
+static void os_continueMove(uint16_t chunks) {
+    MovableBlock const *const block = move.block;
+    MemDriver const *const driver = block->heap->driver;
+    uint16_t const stop = (move.size - move.copied > chunks) ? move.copied + chunks : move.size;
+    // Upwards, so no chunk is overwritten before it was copied
+    for (; move.copied < stop; move.copied++) {
+        driver->write(block->addr + move.copied, driver->read(move.from + move.copied));
+    }
+    if (move.copied == move.size) {
+        os_truncateAllocation(block->heap, block->addr, move.size);
+        move.block = NULL;
+    }
+}
+
+/*!
+ *  Allocates movable memory for the calling process. If there is no run of
+ *  free chunks that is large enough, the heap is compacted right away until
+ *  there is one or no allocation can be moved anymore.
+ *
+ *  \param heap The heap to allocate in.
+ *  \param size The number of bytes needed.
+ *  \return The handle of the memory or INVALID_HANDLE if there is no
+ *          memory, no unused handle or if called by the idle process.
+ */
+MemHandle os_hmalloc(Heap *heap, uint16_t size) {
+    if (!size || !os_getCurrentProc()) {
+        return INVALID_HANDLE;
+    }
+
+    MemAddr addr;
+    // The first pass may have started in the middle of the heap
+    uint8_t passes = 2;
+    while (!(addr = os_malloc(heap, size))) {
+        if (!os_compactHeapStep(heap) && !--passes) {
+            return INVALID_HANDLE;
+        }
+    }
+
+    os_enterCriticalSection();
+    for (MemHandle handle = 0; handle < MAX_NUMBER_OF_HANDLES; handle++) {
+        if (!blocks[handle].heap) {
+            blocks[handle] = (MovableBlock){
+                .heap = heap,
+                .addr = addr,
+                .owner = os_getCurrentProc(),
+                .locks = 0,
+            };
+            os_leaveCriticalSection();
+            return handle;
+        }
+    }
+    os_free(heap, addr);
+    os_leaveCriticalSection();
+    return INVALID_HANDLE;
+}
+
+/*!
+ *  Frees a movable allocation of the calling process, even if it is still
+ *  locked.
+ *
+ *  \param handle The handle of the allocation.
+ */
+void os_hfree(MemHandle handle) {
+    os_enterCriticalSection();
+    MovableBlock *const block = os_getBlock(handle);
+    if (block) {
+        // During a move this frees the chunks moved to and from
+        os_free(block->heap, block->addr);
+        block->heap = NULL;
+        if (move.block == block) {
+            move.block = NULL;
+        }
+    }
+    os_leaveCriticalSection();
+}
+
+/*!
+ *  Pins a movable allocation of the calling process, so its address stays
+ *  valid until it is unlocked as often as it was locked. If the allocation
+ *  is being moved, the rest of it is copied first.
+ *
+ *  \param handle The handle of the allocation.
+ *  \return The address of the allocation, 0 if the handle is invalid.
+ */
+MemAddr os_lockHandle(MemHandle handle) {
+    os_enterCriticalSection();
+    MovableBlock *const block = os_getBlock(handle);
+    MemAddr addr = 0;
+    if (block) {
+        if (block->locks == UINT8_MAX) {
+            os_error("Handle locked too often");
+        } else {
+            if (move.block == block) {
+                os_continueMove(UINT16_MAX);
+            }
+            block->locks++;
+            addr = block->addr;
+        }
+    }
+    os_leaveCriticalSection();
+    return addr;
+}
+
+/*!
+ *  Releases a pin of a movable allocation of the calling process. The
+ *  address returned by os_lockHandle must not be used anymore afterwards.
+ *
+ *  \param handle The handle of the allocation.
+ */
+void os_unlockHandle(MemHandle handle) {
+    os_enterCriticalSection();
+    MovableBlock *const block = os_getBlock(handle);
+    if (block && block->locks) {
+        block->locks--;
+    }
+    os_leaveCriticalSection();
+}
+
+/*!
+ *  Determines the size of a movable allocation of the calling process.
+ *
+ *  \param handle The handle of the allocation.
+ *  \return The number of bytes, 0 if the handle is invalid.
+ */
+uint16_t os_getHandleSize(MemHandle handle) {
+    os_enterCriticalSection();
+    MovableBlock const *const block = os_getBlock(handle);
+    uint16_t size = 0;
+    if (block && move.block == block) {
+        size = move.size;
+    } else if (block) {
+        size = os_getChunkSize(block->heap, block->addr);
+    }
+    os_leaveCriticalSection();
+    return size;
+}
+
+/*!
+ *  Marks the handles of a terminated process unused. Its memory is freed by
+ *  os_freeProcessMemory. Called with the scheduler disabled.
+ *
+ *  \param pid The terminated process.
+ */
+void os_releaseProcessHandles(ProcessID pid) {
+    for (MemHandle handle = 0; handle < MAX_NUMBER_OF_HANDLES; handle++) {
+        if (blocks[handle].owner == pid) {
+            blocks[handle].heap = NULL;
+        }
+    }
+    if (move.block && move.block->owner == pid) {
+        move.block = NULL;
+    }
+}
+
+/*!
+ *  Copies the next COMPACTION_CHUNKS chunks if an allocation is being moved
+ *  (in any heap). Otherwise starts to move the allocation behind the first
+ *  free run (starting where the last move stopped) down to the start of the
+ *  run. An allocation that cannot be moved is skipped. Once there is no
+ *  allocation behind the free run, the next step starts at the start of the
+ *  heap again.
+ *
+ *  \param heap The heap to compact.
+ *  \return True, iff chunks were copied or an allocation was skipped, false
+ *          if the heap was compact from where the step started.
+ */
+bool os_compactHeapStep(Heap *heap) {
+    os_enterCriticalSection();
+    if (move.block) {
+        os_continueMove(COMPACTION_CHUNKS);
+        os_leaveCriticalSection();
+        return true;
+    }
+
+    MemAddr const end = os_getUseStart(heap) + os_getUseSize(heap);
+    MemAddr const hole = os_skipChunks(heap, heap->compactFrom, end, true);
+    MemAddr const next = os_skipChunks(heap, hole, end, false);
+    if (next >= end) {
+        heap->compactFrom = os_getUseStart(heap);
+        os_leaveCriticalSection();
+        return false;
+    }
+
+    MovableBlock *block = NULL;
+    for (MemHandle handle = 0; handle < MAX_NUMBER_OF_HANDLES; handle++) {
+        if (blocks[handle].heap == heap && blocks[handle].addr == next) {
+            block = &blocks[handle];
+            break;
+        }
+    }
+    if (block && !block->locks) {
+        move = (Move){
+            .block = block,
+            .from = next,
+            .size = os_getChunkSize(heap, next),
+            .copied = 0,
+        };
+        os_extendAllocation(heap, next, hole);
+        block->addr = hole;
+        heap->compactFrom = hole + move.size;
+        os_continueMove(COMPACTION_CHUNKS);
+    } else {
+        heap->compactFrom = next + os_getChunkSize(heap, next);
+    }
+    os_leaveCriticalSection();
+    return true;
+}
+
+/*!
+ *  The program of the compactor process: compacts all heaps a step at a
+ *  time and yields after every step, so a move may take several time
+ *  slices. As it has the lowest priority, it only
+ *  uses the processor the other processes leave over.
+ */
+void os_compactor(void) {
+    for (;;) {
+        bool busy = false;
+        for (uint8_t i = 0; i < os_getHeapListLength(); i++) {
+            busy |= os_compactHeapStep(os_lookupHeap(i));
+        }
+        if (busy) {
+            os_yield();
+        } else {
+            os_sleep(COMPACTION_PERIOD);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*! \file
+ *  \brief Movable heap allocations.
+ *
+ *  A movable allocation is referred to by a handle instead of its address.
+ *  The owner locks the handle to get the address and unlocks it after the
+ *  access; in between the compactor moves unlocked allocations to the start
+ *  of the heap, so the free chunks form one run and large allocations keep
+ *  succeeding in a long-running system.
+ */
+
+#ifndef _OS_HANDLES_H
+#define _OS_HANDLES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "defines.h"
+#include "os_memory.h"
+#include "os_programs.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! The type of a handle of a movable allocation
+typedef uint8_t MemHandle;
+
+//----------------------------------------------------------------------------
+// Macros
+//----------------------------------------------------------------------------
+
+//! Returned by os_hmalloc if there is no memory or no handle left
+#define INVALID_HANDLE 255
+
+//! Priority of the compactor, it only gets the processor left over
+#define COMPACTOR_PRIORITY 1
+
+//! Registry entry for the compactor, to be listed in REGISTER_PROGRAMS
+#define COMPACTOR_PROGRAM PROGRAM("compactor", os_compactor, COMPACTOR_PRIORITY, STACK_SIZE_PROC, OS_PF_AUTOSTART | OS_PF_SINGLETON | OS_PF_SYSTEM)
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Allocates movable memory for the calling process
+MemHandle os_hmalloc(Heap *heap, uint16_t size);
+
+//! Frees a movable allocation of the calling process
+void os_hfree(MemHandle handle);
+
+//! Pins a movable allocation and returns its address
+MemAddr os_lockHandle(MemHandle handle);
+
+//! Releases a pin of a movable allocation
+void os_unlockHandle(MemHandle handle);
+
+//! Size of a movable allocation
+uint16_t os_getHandleSize(MemHandle handle);
+
+//! Releases the handles of a terminated process
+void os_releaseProcessHandles(ProcessID pid);
+
+//! Copies a few chunks of an allocation that is moved towards the start of its heap
+bool os_compactHeapStep(Heap *heap);
+
+//! The program of the compactor process
+void os_compactor(void);
+
+#endif
@@ -1,7 +1,13 @@
 #include "os_input.h"
 
 #include <avr/io.h>
+#include <stdbool.h>
 #include <stdint.h>
+
+#include "defines.h"
+#include "os_process.h"
+#include "os_scheduler.h"
+#include "util.h"
 /*! \file
 
 Everything that is necessary to get the input from the Buttons in a clean format.
@@ -51,3 +57,93 @@ void os_waitForCertainInput(uint8_t input) {
     while ((os_getInput() & input) == 0)
         ;
 }
+
+//! The buttons pressed at the last scheduler tick
+static uint8_t lastInput = 0;
+
+//! The buttons that were pressed since the events were taken last
+static uint8_t pressedEvents = 0;
+
+//! The process waiting in os_waitInputEvent
+static ProcessID eventWaiter = INVALID_PROCESS;
+
+//! Whether the waiting process has a timeout
+static bool eventTimed;
+
+//! System time (see os_systemTime_augment) at which the waiting process times out
+static Time eventDeadline;
+
+/*!
+ *  Records which buttons were pressed since the last tick and wakes up the
+ *  process waiting for input if there is one or its timeout elapsed.
+ *  Called by the scheduler on every tick, with interrupts disabled.
+ */
+void os_inputTick(void) {
+    uint8_t const input = os_getInput();
+    pressedEvents |= input & ~lastInput;
+    lastInput = input;
+
+    if (eventWaiter != INVALID_PROCESS && (pressedEvents || (eventTimed && (int32_t)(os_systemTime_augment() - eventDeadline) >= 0))) {
+        os_unblockFromISR(eventWaiter);
+        eventWaiter = INVALID_PROCESS;
+    }
+}
+
+/*!
+ *  Forgets a terminated process that waited for input, so it is not woken
+ *  up in place of a later process in the same slot. Called with the
+ *  scheduler disabled.
+ *
+ *  \param pid The terminated process.
+ */
+void os_releaseProcessInput(ProcessID pid) {
+    if (eventWaiter == pid) {
+        eventWaiter = INVALID_PROCESS;
+    }
+}
+
+/*!
+ *  Takes the buttons that were pressed since the last call, without waiting.
+ *  Every press is reported once, no matter how long the button is held.
+ *
+ *  \returns The pressed buttons in the format of os_getInput.
+ */
+uint8_t os_takeInputEvents(void) {
+    os_enterCriticalSection();
+    uint8_t const events = pressedEvents;
+    pressedEvents = 0;
+    os_leaveCriticalSection();
+    return events;
+}
+
+/*!
+ *  Blocks the calling process until a button is pressed or the timeout
+ *  elapsed. Unlike os_waitForInput the processor is free for other processes
+ *  meanwhile. Only one process may wait at a time and it must not be inside
+ *  a critical section.
+ *
+ *  \param timeout Time to wait at most in ms, 0 waits without timeout.
+ *  \returns The buttons pressed since the events were taken last, 0 on timeout.
+ */
+uint8_t os_waitInputEvent(uint16_t timeout) {
+    ProcessID const self = os_getCurrentProc();
+
+    os_enterCriticalSection();
+    eventTimed = timeout != 0;
+    eventDeadline = os_systemTime_augment() + (Time)timeout * TIME_COUNTS_PER_MS;
+    while (!pressedEvents && !(eventTimed && (int32_t)(os_systemTime_augment() - eventDeadline) >= 0)) {
+        eventWaiter = self;
+        os_getProcessSlot(self)->state = OS_PS_BLOCKED;
+        os_leaveCriticalSection();
+        // Input might have arrived between leaving the section and this check
+        if (os_getProcessSlot(self)->state == OS_PS_BLOCKED) {
+            os_yield();
+        }
+        os_enterCriticalSection();
+    }
+    eventWaiter = INVALID_PROCESS;
+    uint8_t const events = pressedEvents;
+    pressedEvents = 0;
+    os_leaveCriticalSection();
+    return events;
+}
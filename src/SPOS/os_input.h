@@ -13,6 +13,8 @@
 
 #include <stdint.h>
 
+#include "os_process.h"
+
 //----------------------------------------------------------------------------
 // Function headers
 //----------------------------------------------------------------------------
@@ -35,4 +37,16 @@ void os_waitForInputOrTimeout(uint16_t timeout);
 //! Waits for a certain input to be pressed
 void os_waitForCertainInput(uint8_t input);
 
+//! Records button presses as events, called by the scheduler
+void os_inputTick(void);
+
+//! Takes the buttons pressed since the last call
+uint8_t os_takeInputEvents(void);
+
+//! Blocks the calling process until a button is pressed or a timeout occurs
+uint8_t os_waitInputEvent(uint16_t timeout);
+
+//! Forgets a terminated process that waited for input
+void os_releaseProcessInput(ProcessID pid);
+
 #endif
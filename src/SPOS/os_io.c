@@ -0,0 +1,137 @@
+/*! \file
+ *  \brief Standard streams of the processes.
+ *
+ *  stdout and stderr point to dispatching streams that pass every character
+ *  on to the stream the running process bound them to. Nothing has to be
+ *  swapped when the scheduler switches processes, the binding is only looked
+ *  up when a process actually writes. So a chatty process can be moved onto
+ *  another sink (e.g. a pipe) without touching its code.
+ */
+
+#include "os_io.h"
+
+#include <util/atomic.h>
+
+#include "defines.h"
+#include "lcd.h"
+#include "os_scheduler.h"
+#include "util.h"
+
+//----------------------------------------------------------------------------
+// Private function declarations
+//----------------------------------------------------------------------------
+
+//! Passes a character written to stdout on to the stream of the running process
+static int os_dispatchOut(char c, FILE *stream);
+
+//! Passes a character written to stderr on to the stream of the running process
+static int os_dispatchErr(char c, FILE *stream);
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! The stream stdout points to
+static FILE dispatchOut = FDEV_SETUP_STREAM(os_dispatchOut, NULL, _FDEV_SETUP_WRITE);
+
+//! The stream stderr points to
+static FILE dispatchErr = FDEV_SETUP_STREAM(os_dispatchErr, NULL, _FDEV_SETUP_WRITE);
+
+//! The streams the standard streams of every process are bound to
+static FILE *bindings[MAX_NUMBER_OF_PROCESSES][OS_STD_STREAM_COUNT];
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Writes a character to a standard stream of the running process.
+ *
+ *  \param c The character to write.
+ *  \param which The standard stream that was written to.
+ *  \return 0 on success, EOF if the bound stream failed.
+ */
+static int os_dispatch(char c, StandardStream which) {
+    FILE *const target = bindings[os_getCurrentProc()][which];
+    if (!target || target == &dispatchOut || target == &dispatchErr) {
+        // Unbound or bound to a dispatcher (which would recurse): discard
+        return 0;
+    }
+    return fputc(c, target) == EOF ? EOF : 0;
+}
+
+static int os_dispatchOut(char c, FILE *stream) {
+    return os_dispatch(c, OS_STDOUT);
+}
+
+static int os_dispatchErr(char c, FILE *stream) {
+    return os_dispatch(c, OS_STDERR);
+}
+
+/*!
+ *  Points stdout and stderr to the dispatching streams and binds the
+ *  standard streams of every process to the LCD.
+ */
+void os_initIO(void) {
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        os_resetProcessStreams(pid);
+    }
+    stdout = &dispatchOut;
+    stderr = &dispatchErr;
+}
+
+/*!
+ *  Binds a standard stream of a process to a stream, e.g. a pipe or the
+ *  USART. The stream must stay valid as long as it is bound.
+ *
+ *  \param pid The process whose stream is redirected.
+ *  \param which The standard stream to redirect.
+ *  \param stream The new target or NULL to discard the output.
+ *  \return True, iff process and standard stream are valid.
+ */
+bool os_setProcessStream(ProcessID pid, StandardStream which, FILE *stream) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES || which >= OS_STD_STREAM_COUNT) {
+        return false;
+    }
+
+    ATOMIC {
+        bindings[pid][which] = stream;
+    }
+    return true;
+}
+
+/*!
+ *  A simple getter for the binding of a standard stream.
+ *
+ *  \param pid The process to look up.
+ *  \param which The standard stream to look up.
+ *  \return The stream the standard stream is bound to or NULL.
+ */
+FILE *os_getProcessStream(ProcessID pid, StandardStream which) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES || which >= OS_STD_STREAM_COUNT) {
+        return NULL;
+    }
+
+    FILE *stream;
+    ATOMIC {
+        stream = bindings[pid][which];
+    }
+    return stream;
+}
+
+/*!
+ *  Binds both standard streams of a process to the LCD. Called by os_exec so
+ *  a new process does not inherit the redirection of the previous one.
+ *
+ *  \param pid The process whose streams are reset.
+ */
+void os_resetProcessStreams(ProcessID pid) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES) {
+        return;
+    }
+
+    ATOMIC {
+        bindings[pid][OS_STDOUT] = lcdout;
+        bindings[pid][OS_STDERR] = lcdout;
+    }
+}
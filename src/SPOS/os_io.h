@@ -0,0 +1,42 @@
+/*! \file
+ *  \brief Standard streams of the processes.
+ *
+ *  Contains the per-process binding of stdout and stderr.
+ */
+
+#ifndef _OS_IO_H
+#define _OS_IO_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "os_process.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! The standard streams a process may redirect
+typedef enum StandardStream {
+    OS_STDOUT,
+    OS_STDERR,
+    OS_STD_STREAM_COUNT
+} StandardStream;
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Installs the dispatching standard streams and binds every process to the LCD
+void os_initIO(void);
+
+//! Binds a standard stream of a process to a stream
+bool os_setProcessStream(ProcessID pid, StandardStream which, FILE *stream);
+
+//! Returns the stream a standard stream of a process is bound to
+FILE *os_getProcessStream(ProcessID pid, StandardStream which);
+
+//! Binds the standard streams of a process to the LCD again
+void os_resetProcessStreams(ProcessID pid);
+
+#endif
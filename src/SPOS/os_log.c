@@ -0,0 +1,126 @@
+/*! \file
+ *  \brief Deferred binary logging.
+ *
+ *  A record consists of the number of arguments, the flash address of the
+ *  format string (low byte first) and the arguments (low byte first), all
+ *  packed into a ring buffer. Appending a record is a matter of copying a few
+ *  bytes, the expensive formatting happens on the host. If a record does not
+ *  fit, it is dropped and counted instead of overwriting older records, so
+ *  the host never sees a torn record.
+ *
+ *  os_flushLog sends every record as a frame
+ *      LOG_SYNC1 LOG_SYNC2 <length> <record> <crc>
+ *  with the layout and CRC of the telemetry frames (see os_telemetry.c), so
+ *  the records can share the USART with the text of the shell.
+ */
+
+#include "os_log.h"
+
+#include <util/atomic.h>
+#include <util/crc16.h>
+
+#include "defines.h"
+#include "util.h"
+
+#if LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1) || LOG_BUFFER_SIZE > 128
+#error "LOG_BUFFER_SIZE must be a power of two <= 128"
+#endif
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! The ring buffer holding the records
+static uint8_t buffer[LOG_BUFFER_SIZE];
+
+//! Index of the oldest byte in the buffer
+static uint8_t head;
+
+//! Number of bytes in the buffer
+static uint8_t fill;
+
+//! Number of records dropped since the last flush
+static uint8_t dropped;
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Appends a byte behind the last one. The caller has checked for room.
+ *
+ *  \param byte The byte to append.
+ */
+static inline void os_logPut(uint8_t byte) {
+    buffer[(head + fill) & (LOG_BUFFER_SIZE - 1)] = byte;
+    fill++;
+}
+
+/*!
+ *  Appends a record to the log. May be called from interrupt service routines.
+ *
+ *  \param format Flash address of the format string.
+ *  \param args The arguments of the format string.
+ *  \param count Number of arguments.
+ */
+void os_logRecord(char const *format, uint16_t const *args, uint8_t count) {
+    uint8_t const size = 3 + 2 * count;
+    ATOMIC {
+        if (size > LOG_BUFFER_SIZE - fill) {
+            if (dropped < UINT8_MAX) {
+                dropped++;
+            }
+        } else {
+            os_logPut(count);
+            os_logPut((uint16_t)format);
+            os_logPut((uint16_t)format >> 8);
+            for (uint8_t i = 0; i < count; i++) {
+                os_logPut(args[i]);
+                os_logPut(args[i] >> 8);
+            }
+        }
+    }
+}
+
+/*!
+ *  Writes all records to a stream (e.g. the USART) as frames read by
+ *  tools/spos_log.py and empties the log. New records may be appended
+ *  meanwhile, they are flushed as well. A record is removed only after it
+ *  was written, so only one process may flush at a time.
+ *
+ *  \param stream The stream to write to.
+ */
+void os_flushLog(FILE *stream) {
+    // Records are only appended behind the last one, so the oldest stays put while it is sent
+    while (fill) {
+        uint8_t const size = 3 + 2 * buffer[head];
+        uint16_t crc = _crc_ccitt_update(0xFFFF, size);
+        fputc(LOG_SYNC1, stream);
+        fputc(LOG_SYNC2, stream);
+        fputc(size, stream);
+        for (uint8_t i = 0; i < size; i++) {
+            uint8_t const byte = buffer[(head + i) & (LOG_BUFFER_SIZE - 1)];
+            crc = _crc_ccitt_update(crc, byte);
+            fputc(byte, stream);
+        }
+        fputc(crc, stream);
+        fputc(crc >> 8, stream);
+        ATOMIC {
+            head = (head + size) & (LOG_BUFFER_SIZE - 1);
+            fill -= size;
+        }
+    }
+    ATOMIC {
+        dropped = 0;
+    }
+}
+
+/*!
+ *  A simple getter for the number of dropped records.
+ *
+ *  \return The number of records that did not fit into the log since the
+ *          last flush (saturates at 255).
+ */
+uint8_t os_getDroppedLogRecords(void) {
+    return dropped;
+}
@@ -0,0 +1,51 @@
+/*! \file
+ *  \brief Deferred binary logging.
+ *
+ *  Contains a log that only records the flash address of the format string
+ *  and the raw arguments. The text is produced on the host by
+ *  tools/spos_log.py, which looks the format strings up in the ELF file.
+ */
+
+#ifndef _OS_LOG_H
+#define _OS_LOG_H
+
+#include <avr/pgmspace.h>
+#include <stdint.h>
+#include <stdio.h>
+
+//----------------------------------------------------------------------------
+// Macros
+//----------------------------------------------------------------------------
+
+//! First byte of every frame, the same as of telemetry frames so receivers can tell both from text alike
+#define LOG_SYNC1 0xA5
+
+//! Second byte of every frame, telling log frames from telemetry frames
+#define LOG_SYNC2 0x4C
+
+/*!
+ *  Logs a printf-like message. Every argument is recorded as a 16 bit word,
+ *  so 32 bit values have to be wrapped in LOG32 (and printed with an l
+ *  modifier). Strings can only be logged from flash (%S).
+ *  Example: os_log("pid %u slept %lu ms", pid, LOG32(duration));
+ */
+#define os_log(FMT, ...) \
+    os_logRecord(PSTR(FMT), (uint16_t const[]){0, ##__VA_ARGS__} + 1, sizeof((uint16_t const[]){0, ##__VA_ARGS__}) / sizeof(uint16_t) - 1)
+
+//! Splits a 32 bit log argument into two words (low word first)
+#define LOG32(X) ((uint16_t)(uint32_t)(X)), ((uint16_t)((uint32_t)(X) >> 16))
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Appends a record to the log, use the macro os_log instead
+void os_logRecord(char const *format, uint16_t const *args, uint8_t count);
+
+//! Writes all records as frames to a stream and removes them from the log
+void os_flushLog(FILE *stream);
+
+//! Number of records dropped since the last flush because the log was full
+uint8_t os_getDroppedLogRecords(void);
+
+#endif
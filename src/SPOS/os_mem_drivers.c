@@ -0,0 +1,85 @@
+/*! \file
+ *  \brief Drivers of the memory devices heaps reside in.
+ */
+
+#include "os_mem_drivers.h"
+
+#include "defines.h"
+
+//----------------------------------------------------------------------------
+// Private function declarations
+//----------------------------------------------------------------------------
+
+//! Init function of intSRAM
+static void os_initSRAM_internal(void);
+
+//! Read function of intSRAM
+static MemValue os_readSRAM_internal(MemAddr addr);
+
+//! Word read function of intSRAM
+static uint16_t os_readWordSRAM_internal(MemAddr addr);
+
+//! Write function of intSRAM
+static void os_writeSRAM_internal(MemAddr addr, MemValue value);
+
+//----------------------------------------------------------------------------
+// Globals
+//----------------------------------------------------------------------------
+
+MemDriver intSRAM__ = {
+    .start = AVR_SRAM_START,
+    .size = AVR_MEMORY_SRAM,
+    .init = os_initSRAM_internal,
+    .read = os_readSRAM_internal,
+    .readWord = os_readWordSRAM_internal,
+    .write = os_writeSRAM_internal,
+};
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Initializes all memory devices. Called by os_init before the heaps are
+ *  set up.
+ */
+void os_initMemDrivers(void) {
+    intSRAM->init();
+}
+
+/*!
+ *  The internal SRAM needs no preparation.
+ */
+static void os_initSRAM_internal(void) {
+}
+
+/*!
+ *  Reads a byte of the internal SRAM.
+ *
+ *  \param addr The address to read.
+ *  \return The byte at the address.
+ */
+static MemValue os_readSRAM_internal(MemAddr addr) {
+    return *(MemValue volatile *)addr;
+}
+
+/*!
+ *  Reads two bytes of the internal SRAM, which needs half the instructions of
+ *  two separate reads.
+ *
+ *  \param addr The address of the first byte.
+ *  \return The first byte in the low byte, the second one in the high byte.
+ */
+static uint16_t os_readWordSRAM_internal(MemAddr addr) {
+    return *(uint16_t volatile *)addr;
+}
+
+/*!
+ *  Writes a byte of the internal SRAM.
+ *
+ *  \param addr The address to write.
+ *  \param value The byte to write.
+ */
+static void os_writeSRAM_internal(MemAddr addr, MemValue value) {
+    *(MemValue volatile *)addr = value;
+}
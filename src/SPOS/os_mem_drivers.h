@@ -0,0 +1,61 @@
+/*! \file
+ *  \brief Drivers of the memory devices heaps reside in.
+ *
+ *  A memory device is accessed byte by byte through its driver, so the heap
+ *  management does not depend on where the memory is.
+ */
+
+#ifndef _OS_MEM_DRIVERS_H
+#define _OS_MEM_DRIVERS_H
+
+#include <stdint.h>
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! An address on a memory device
+typedef uint16_t MemAddr;
+
+//! A byte on a memory device
+typedef uint8_t MemValue;
+
+//! The driver of a memory device
+typedef struct MemDriver {
+    //! First valid address
+    MemAddr start;
+
+    //! Number of bytes of the device
+    uint16_t size;
+
+    //! Prepares the device for reading and writing
+    void (*init)(void);
+
+    //! Reads the byte at an address
+    MemValue (*read)(MemAddr addr);
+
+    //! Reads the bytes at an address and the next one at once, the first one in the low byte
+    uint16_t (*readWord)(MemAddr addr);
+
+    //! Writes the byte at an address
+    void (*write)(MemAddr addr, MemValue value);
+} MemDriver;
+
+//----------------------------------------------------------------------------
+// Globals
+//----------------------------------------------------------------------------
+
+//! The driver of the internal SRAM
+extern MemDriver intSRAM__;
+
+//! Pointer to the driver of the internal SRAM
+#define intSRAM (&intSRAM__)
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Initializes all memory devices
+void os_initMemDrivers(void);
+
+#endif
@@ -0,0 +1,109 @@
+/*! \file
+ *  \brief The heaps of the OS.
+ *
+ *  The internal heap takes the SRAM between the globals and the stacks of
+ *  the processes. A third of it is the map, as every map byte describes two
+ *  chunks of the use area.
+ */
+
+#include "os_memheap_drivers.h"
+
+#include <avr/pgmspace.h>
+
+#include "os_core.h"
+#include "os_process.h"
+
+//----------------------------------------------------------------------------
+// Private constants
+//----------------------------------------------------------------------------
+
+//! First address of the SRAM not occupied by globals (set by the linker)
+extern char __heap_start;
+
+//! First address of the stacks of the processes
+#define HEAP_END (PROCESS_STACK_BOTTOM(MAX_NUMBER_OF_PROCESSES) + 1)
+
+//! Name of intHeap
+static char intHeapName[] = "internal";
+
+//! All heaps
+static Heap *const heapList[] PROGMEM = {
+    intHeap,
+};
+
+//----------------------------------------------------------------------------
+// Globals
+//----------------------------------------------------------------------------
+
+Heap intHeap__ = {
+    .driver = intSRAM,
+    .strategy = OS_MEM_FIRST,
+    .name = intHeapName,
+};
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Places the map and the use area of a heap in a region of its device and
+ *  marks all chunks free.
+ *
+ *  \param heap The heap to lay out.
+ *  \param start First byte of the region.
+ *  \param size Number of bytes of the region.
+ */
+static void os_layOutHeap(Heap *heap, MemAddr start, uint16_t size) {
+    heap->mapStart = start;
+    heap->mapSize = size / 3;
+    heap->useStart = start + heap->mapSize;
+    heap->useSize = 2 * heap->mapSize;
+    heap->nextFit = heap->useStart;
+    heap->compactFrom = heap->useStart;
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        heap->allocFrameStart[pid] = heap->useStart + heap->useSize;
+        heap->allocFrameEnd[pid] = heap->useStart;
+    }
+    for (MemAddr addr = heap->mapStart; addr < heap->useStart; addr++) {
+        heap->driver->write(addr, 0);
+    }
+}
+
+/*!
+ *  Lays out all heaps and marks them free. Called by os_init after the
+ *  memory devices were initialized. If the globals reach into the stacks of
+ *  the processes, an error is shown and the internal heap stays empty.
+ */
+void os_initHeaps(void) {
+    MemAddr const start = (MemAddr)(uintptr_t)&__heap_start;
+    uint16_t size = 0;
+    // A region of less than three bytes has no room for a single chunk besides the map
+    if (start + 3 > HEAP_END) {
+        os_error("Globals overlap process stacks");
+    } else {
+        size = HEAP_END - start;
+    }
+    os_layOutHeap(intHeap, start, size);
+}
+
+/*!
+ *  A simple getter for the number of heaps.
+ *
+ *  \return The number of heaps.
+ */
+uint8_t os_getHeapListLength(void) {
+    return sizeof(heapList) / sizeof(heapList[0]);
+}
+
+/*!
+ *  Looks up a heap by its index, e.g. for the task manager.
+ *
+ *  \param index The index of the heap.
+ *  \return The heap or NULL if there is none with this index.
+ */
+Heap *os_lookupHeap(uint8_t index) {
+    if (index >= os_getHeapListLength()) {
+        return NULL;
+    }
+    return (Heap *)pgm_read_word(&heapList[index]);
+}
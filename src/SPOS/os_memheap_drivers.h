@@ -0,0 +1,89 @@
+/*! \file
+ *  \brief The heaps of the OS.
+ *
+ *  A heap divides a region of a memory device into a map and a use area.
+ *  Every byte of the use area is a chunk, which is described by a nibble of
+ *  the map: 0 if it is free, the ID of the owning process in the first chunk
+ *  of an allocation and 0xF in the following ones.
+ */
+
+#ifndef _OS_MEMHEAP_DRIVERS_H
+#define _OS_MEMHEAP_DRIVERS_H
+
+#include <stdint.h>
+
+#include "defines.h"
+#include "os_mem_drivers.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! The strategies to find free memory
+typedef enum AllocStrategy {
+    OS_MEM_FIRST,
+    OS_MEM_NEXT,
+    OS_MEM_BEST,
+    OS_MEM_WORST
+} AllocStrategy;
+
+//! A heap on a memory device
+typedef struct Heap {
+    //! The device the heap resides on
+    MemDriver *driver;
+
+    //! First byte of the map
+    MemAddr mapStart;
+
+    //! Number of bytes of the map
+    uint16_t mapSize;
+
+    //! First chunk of the use area
+    MemAddr useStart;
+
+    //! Number of chunks of the use area (twice the map size)
+    uint16_t useSize;
+
+    //! The strategy os_malloc uses
+    AllocStrategy strategy;
+
+    //! Chunk the next-fit strategy continues searching at
+    MemAddr nextFit;
+
+    //! Chunk the compaction continues at
+    MemAddr compactFrom;
+
+    //! First chunk of the first allocation of every process, useStart + useSize if none
+    MemAddr allocFrameStart[MAX_NUMBER_OF_PROCESSES];
+
+    //! Chunk after the last allocation of every process, useStart if none
+    MemAddr allocFrameEnd[MAX_NUMBER_OF_PROCESSES];
+
+    //! Name shown by the task manager
+    char const *name;
+} Heap;
+
+//----------------------------------------------------------------------------
+// Globals
+//----------------------------------------------------------------------------
+
+//! The heap in the internal SRAM
+extern Heap intHeap__;
+
+//! Pointer to the heap in the internal SRAM
+#define intHeap (&intHeap__)
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Lays out all heaps and marks them free
+void os_initHeaps(void);
+
+//! Number of heaps
+uint8_t os_getHeapListLength(void);
+
+//! The heap with a certain index
+Heap *os_lookupHeap(uint8_t index);
+
+#endif
@@ -0,0 +1,392 @@
+/*! \file
+ *  \brief Allocation of heap memory.
+ *
+ *  The map of a heap stores the owner in the first chunk of every
+ *  allocation, so the allocations of a process can be found without any
+ *  further bookkeeping. To keep freeing all of them on exit short, every
+ *  heap remembers the range of chunks each process ever allocated in.
+ *  The idle process cannot allocate, as its ID marks free chunks.
+ */
+
+#include "os_memory.h"
+
+#include "os_core.h"
+#include "os_memory_strategies.h"
+#include "os_scheduler.h"
+
+//----------------------------------------------------------------------------
+// Private constants
+//----------------------------------------------------------------------------
+
+//! Map nibble of the chunks of an allocation after its first one
+#define MAP_FOLLOWING 0xF
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Reads the map nibble of a chunk: the high nibble of a map byte describes
+ *  the even chunk, the low nibble the odd one.
+ *
+ *  \param heap The heap of the chunk.
+ *  \param addr The chunk.
+ *  \return 0 if the chunk is free, MAP_FOLLOWING if it continues an
+ *          allocation and the owner otherwise.
+ */
+MemValue os_getMapEntry(Heap const *heap, MemAddr addr) {
+    uint16_t const offset = addr - heap->useStart;
+    MemValue const byte = heap->driver->read(heap->mapStart + offset / 2);
+    return (offset & 1) ? (byte & 0x0F) : (byte >> 4);
+}
+
+/*!
+ *  Writes the map nibble of a chunk.
+ *
+ *  \param heap The heap of the chunk.
+ *  \param addr The chunk.
+ *  \param value The nibble to write.
+ */
+static void os_setMapEntry(Heap const *heap, MemAddr addr, MemValue value) {
+    uint16_t const offset = addr - heap->useStart;
+    MemAddr const mapAddr = heap->mapStart + offset / 2;
+    MemValue const byte = heap->driver->read(mapAddr);
+    if (offset & 1) {
+        heap->driver->write(mapAddr, (byte & 0xF0) | value);
+    } else {
+        heap->driver->write(mapAddr, (byte & 0x0F) | (value << 4));
+    }
+}
+
+/*!
+ *  Reads the map nibbles of four chunks at once. Their order in the word
+ *  does not matter, as the word is only tested as a whole.
+ *
+ *  \param heap The heap of the chunks.
+ *  \param addr The first of the chunks, a multiple of four chunks behind the
+ *              start of the use area.
+ *  \return The four nibbles.
+ */
+static uint16_t os_getMapWord(Heap const *heap, MemAddr addr) {
+    return heap->driver->readWord(heap->mapStart + (addr - heap->useStart) / 2);
+}
+
+/*!
+ *  Skips chunks as long as they are allocated (or free). Between the chunk
+ *  boundaries that are multiples of four, four map nibbles are tested per
+ *  step, so a long run costs a quarter of the steps.
+ *
+ *  \param heap The heap to search.
+ *  \param addr The chunk to start at.
+ *  \param end The chunk to stop at.
+ *  \param allocated Whether allocated chunks are skipped rather than free ones.
+ *  \return The first chunk that is not skipped or end.
+ */
+MemAddr os_skipChunks(Heap const *heap, MemAddr addr, MemAddr end, bool allocated) {
+    while (addr < end && ((addr - heap->useStart) & 3)) {
+        if ((os_getMapEntry(heap, addr) != 0) != allocated) {
+            return addr;
+        }
+        addr++;
+    }
+    while (end - addr >= 4) {
+        uint16_t const word = os_getMapWord(heap, addr);
+        // Every nibble that is not 0 leaves a 1 in its lowest bit
+        bool const skip = allocated ? ((word | word >> 1 | word >> 2 | word >> 3) & 0x1111) == 0x1111 : !word;
+        if (!skip) {
+            break;
+        }
+        addr += 4;
+    }
+    while (addr < end && (os_getMapEntry(heap, addr) != 0) == allocated) {
+        addr++;
+    }
+    return addr;
+}
+
+/*!
+ *  Finds the first chunk of the allocation a chunk belongs to.
+ *
+ *  \param heap The heap of the chunk.
+ *  \param addr An allocated chunk.
+ *  \return The first chunk of the allocation.
+ */
+static MemAddr os_getAllocationStart(Heap const *heap, MemAddr addr) {
+    while (os_getMapEntry(heap, addr) == MAP_FOLLOWING) {
+        addr--;
+    }
+    return addr;
+}
+
+/*!
+ *  Marks the chunks of an allocation free.
+ *
+ *  \param heap The heap of the allocation.
+ *  \param start The first chunk of the allocation.
+ *  \return The chunk after the allocation.
+ */
+static MemAddr os_releaseAllocation(Heap const *heap, MemAddr start) {
+    MemAddr const end = os_getUseStart(heap) + os_getUseSize(heap);
+    os_setMapEntry(heap, start, 0);
+    while (++start < end && os_getMapEntry(heap, start) == MAP_FOLLOWING) {
+        os_setMapEntry(heap, start, 0);
+    }
+    return start;
+}
+
+/*!
+ *  Allocates memory for the calling process with the strategy of the heap.
+ *  The memory is not initialized.
+ *
+ *  \param heap The heap to allocate in.
+ *  \param size The number of bytes needed.
+ *  \return The first byte of the memory, 0 if there is no run of free
+ *          chunks that is large enough, if size is 0 or if called by the
+ *          idle process.
+ */
+MemAddr os_malloc(Heap *heap, uint16_t size) {
+    ProcessID const owner = os_getCurrentProc();
+    if (!size || !owner) {
+        return 0;
+    }
+
+    os_enterCriticalSection();
+    MemAddr addr;
+    switch (heap->strategy) {
+        case OS_MEM_NEXT:
+            addr = os_Memory_NextFit(heap, size);
+            break;
+        case OS_MEM_BEST:
+            addr = os_Memory_BestFit(heap, size);
+            break;
+        case OS_MEM_WORST:
+            addr = os_Memory_WorstFit(heap, size);
+            break;
+        default:
+            addr = os_Memory_FirstFit(heap, size);
+            break;
+    }
+    if (addr) {
+        os_setMapEntry(heap, addr, owner);
+        for (uint16_t i = 1; i < size; i++) {
+            os_setMapEntry(heap, addr + i, MAP_FOLLOWING);
+        }
+        if (addr < heap->allocFrameStart[owner]) {
+            heap->allocFrameStart[owner] = addr;
+        }
+        if (addr + size > heap->allocFrameEnd[owner]) {
+            heap->allocFrameEnd[owner] = addr + size;
+        }
+    }
+    os_leaveCriticalSection();
+
+    return addr;
+}
+
+/*!
+ *  Frees an allocation of the calling process. Freeing the memory of another
+ *  process or memory that is not allocated is an error.
+ *
+ *  \param heap The heap of the allocation.
+ *  \param addr Any byte of the allocation, nothing happens for 0.
+ */
+void os_free(Heap *heap, MemAddr addr) {
+    if (!addr) {
+        return;
+    }
+
+    os_enterCriticalSection();
+    if (addr < os_getUseStart(heap) || addr >= os_getUseStart(heap) + os_getUseSize(heap) || !os_getMapEntry(heap, addr)) {
+        os_leaveCriticalSection();
+        os_error("Freeing unallocated memory");
+        return;
+    }
+    MemAddr const start = os_getAllocationStart(heap, addr);
+    if (os_getMapEntry(heap, start) != os_getCurrentProc()) {
+        os_leaveCriticalSection();
+        os_error("Freeing foreign memory");
+        return;
+    }
+    os_releaseAllocation(heap, start);
+    os_leaveCriticalSection();
+}
+
+/*!
+ *  Frees all allocations of a process in one pass over the part of the map
+ *  it allocated in. Called when a process terminates, with the scheduler
+ *  disabled.
+ *
+ *  \param heap The heap to free the allocations in.
+ *  \param pid The owner of the allocations.
+ */
+void os_freeProcessMemory(Heap *heap, ProcessID pid) {
+    MemAddr addr = heap->allocFrameStart[pid];
+    MemAddr const end = heap->allocFrameEnd[pid];
+    while (addr < end) {
+        if (os_getMapEntry(heap, addr) == pid) {
+            addr = os_releaseAllocation(heap, addr);
+        } else {
+            addr++;
+        }
+    }
+    heap->allocFrameStart[pid] = os_getUseStart(heap) + os_getUseSize(heap);
+    heap->allocFrameEnd[pid] = os_getUseStart(heap);
+}
+
+/*!
+ *  Extends an allocation down over the free chunks below it, keeping its
+ *  owner, e.g. to move its content down. The chunks between the new and
+ *  the old start must be free. Must be called within a critical section,
+ *  and the caller has to update all references to the allocation.
+ *
+ *  \param heap The heap of the allocation.
+ *  \param start The first chunk of the allocation.
+ *  \param to The new first chunk, below start.
+ */
+void os_extendAllocation(Heap *heap, MemAddr start, MemAddr to) {
+    ProcessID const owner = os_getMapEntry(heap, start);
+    os_setMapEntry(heap, to, owner);
+    for (MemAddr addr = to + 1; addr <= start; addr++) {
+        os_setMapEntry(heap, addr, MAP_FOLLOWING);
+    }
+    if (to < heap->allocFrameStart[owner]) {
+        heap->allocFrameStart[owner] = to;
+    }
+}
+
+/*!
+ *  Shortens an allocation to its first chunks and frees the others. Must be
+ *  called within a critical section.
+ *
+ *  \param heap The heap of the allocation.
+ *  \param start The first chunk of the allocation.
+ *  \param size The number of chunks to keep, at least 1.
+ */
+void os_truncateAllocation(Heap *heap, MemAddr start, uint16_t size) {
+    MemAddr const end = os_getUseStart(heap) + os_getUseSize(heap);
+    for (MemAddr addr = start + size; addr < end && os_getMapEntry(heap, addr) == MAP_FOLLOWING; addr++) {
+        os_setMapEntry(heap, addr, 0);
+    }
+}
+
+/*!
+ *  Determines the size of the allocation a chunk belongs to.
+ *
+ *  \param heap The heap of the chunk.
+ *  \param addr Any chunk of the allocation.
+ *  \return The number of chunks of the allocation, 0 if the chunk is free.
+ */
+uint16_t os_getChunkSize(Heap const *heap, MemAddr addr) {
+    if (!os_getMapEntry(heap, addr)) {
+        return 0;
+    }
+    MemAddr const start = os_getAllocationStart(heap, addr);
+    MemAddr const end = os_getUseStart(heap) + os_getUseSize(heap);
+    MemAddr stop = start + 1;
+    while (stop < end && os_getMapEntry(heap, stop) == MAP_FOLLOWING) {
+        stop++;
+    }
+    return stop - start;
+}
+
+/*!
+ *  Counts the allocated chunks of a heap.
+ *
+ *  \param heap The heap to count in.
+ *  \return The number of allocated bytes.
+ */
+uint16_t os_getHeapUsage(Heap const *heap) {
+    uint16_t usage = 0;
+    for (MemAddr addr = os_getMapStart(heap); addr < os_getMapStart(heap) + os_getMapSize(heap); addr++) {
+        MemValue const byte = heap->driver->read(addr);
+        usage += (byte >> 4 != 0) + ((byte & 0x0F) != 0);
+    }
+    return usage;
+}
+
+/*!
+ *  Counts the chunks a process allocated in a heap.
+ *
+ *  \param heap The heap to count in.
+ *  \param pid The owner of the allocations.
+ *  \return The number of bytes allocated by the process.
+ */
+uint16_t os_getUsage(Heap const *heap, ProcessID pid) {
+    uint16_t usage = 0;
+    MemAddr addr = heap->allocFrameStart[pid];
+    MemAddr const end = heap->allocFrameEnd[pid];
+    while (addr < end) {
+        if (os_getMapEntry(heap, addr) == pid) {
+            uint16_t const size = os_getChunkSize(heap, addr);
+            usage += size;
+            addr += size;
+        } else {
+            addr++;
+        }
+    }
+    return usage;
+}
+
+/*!
+ *  A simple getter for the first byte of the map of a heap.
+ *
+ *  \param heap The heap.
+ *  \return The address of the map.
+ */
+MemAddr os_getMapStart(Heap const *heap) {
+    return heap->mapStart;
+}
+
+/*!
+ *  A simple getter for the size of the map of a heap.
+ *
+ *  \param heap The heap.
+ *  \return The number of bytes of the map.
+ */
+uint16_t os_getMapSize(Heap const *heap) {
+    return heap->mapSize;
+}
+
+/*!
+ *  A simple getter for the first chunk of the use area of a heap.
+ *
+ *  \param heap The heap.
+ *  \return The address of the use area.
+ */
+MemAddr os_getUseStart(Heap const *heap) {
+    return heap->useStart;
+}
+
+/*!
+ *  A simple getter for the size of the use area of a heap.
+ *
+ *  \param heap The heap.
+ *  \return The number of bytes of the use area.
+ */
+uint16_t os_getUseSize(Heap const *heap) {
+    return heap->useSize;
+}
+
+/*!
+ *  Sets the strategy os_malloc uses for a heap. Existing allocations are
+ *  kept.
+ *
+ *  \param heap The heap.
+ *  \param allocStrat The strategy to use from now on.
+ */
+void os_setAllocationStrategy(Heap *heap, AllocStrategy allocStrat) {
+    os_enterCriticalSection();
+    heap->strategy = allocStrat;
+    heap->nextFit = heap->useStart;
+    os_leaveCriticalSection();
+}
+
+/*!
+ *  A simple getter for the strategy os_malloc uses for a heap.
+ *
+ *  \param heap The heap.
+ *  \return The allocation strategy.
+ */
+AllocStrategy os_getAllocationStrategy(Heap const *heap) {
+    return heap->strategy;
+}
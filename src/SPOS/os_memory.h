@@ -0,0 +1,71 @@
+/*! \file
+ *  \brief Allocation of heap memory.
+ *
+ *  Every allocation belongs to the process that requested it. Only the owner
+ *  may free it, and all allocations of a process are freed when it
+ *  terminates.
+ */
+
+#ifndef _OS_MEMORY_H
+#define _OS_MEMORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "os_mem_drivers.h"
+#include "os_memheap_drivers.h"
+#include "os_process.h"
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Allocates memory for the calling process
+MemAddr os_malloc(Heap *heap, uint16_t size);
+
+//! Frees an allocation of the calling process
+void os_free(Heap *heap, MemAddr addr);
+
+//! Frees all allocations of a process
+void os_freeProcessMemory(Heap *heap, ProcessID pid);
+
+//! Extends an allocation down over the free chunks below it
+void os_extendAllocation(Heap *heap, MemAddr start, MemAddr to);
+
+//! Frees the chunks of an allocation behind its first chunks
+void os_truncateAllocation(Heap *heap, MemAddr start, uint16_t size);
+
+//! Map nibble of a chunk
+MemValue os_getMapEntry(Heap const *heap, MemAddr addr);
+
+//! Skips allocated or free chunks
+MemAddr os_skipChunks(Heap const *heap, MemAddr addr, MemAddr end, bool allocated);
+
+//! Size of the allocation a chunk belongs to
+uint16_t os_getChunkSize(Heap const *heap, MemAddr addr);
+
+//! Number of chunks allocated in a heap
+uint16_t os_getHeapUsage(Heap const *heap);
+
+//! Number of chunks a process allocated in a heap
+uint16_t os_getUsage(Heap const *heap, ProcessID pid);
+
+//! First byte of the map of a heap
+MemAddr os_getMapStart(Heap const *heap);
+
+//! Number of bytes of the map of a heap
+uint16_t os_getMapSize(Heap const *heap);
+
+//! First chunk of the use area of a heap
+MemAddr os_getUseStart(Heap const *heap);
+
+//! Number of chunks of the use area of a heap
+uint16_t os_getUseSize(Heap const *heap);
+
+//! Sets the strategy os_malloc uses for a heap
+void os_setAllocationStrategy(Heap *heap, AllocStrategy allocStrat);
+
+//! The strategy os_malloc uses for a heap
+AllocStrategy os_getAllocationStrategy(Heap const *heap);
+
+#endif
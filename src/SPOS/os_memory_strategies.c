@@ -0,0 +1,126 @@
+/*! \file
+ *  \brief Strategies to find free heap memory.
+ *
+ *  All strategies walk the runs of free chunks in the map with os_skipChunks.
+ *  They are called by os_malloc within a critical section.
+ */
+
+#include "os_memory_strategies.h"
+
+#include "os_memory.h"
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Finds the next run of free chunks.
+ *
+ *  \param heap The heap to search.
+ *  \param addr The chunk to start at, set to the first chunk of the run.
+ *  \param end The chunk to stop at.
+ *  \return The number of chunks of the run (which ends at end at the latest),
+ *          0 if there is none.
+ */
+static uint16_t os_nextFreeRun(Heap const *heap, MemAddr *addr, MemAddr end) {
+    MemAddr const start = os_skipChunks(heap, *addr, end, true);
+    *addr = start;
+    return os_skipChunks(heap, start, end, false) - start;
+}
+
+/*!
+ *  Finds the first run of free chunks that is large enough within a range.
+ *
+ *  \param heap The heap to search.
+ *  \param size The number of chunks needed.
+ *  \param addr The chunk to start at.
+ *  \param end The chunk to stop at.
+ *  \return The first chunk of the run or 0 if there is none.
+ */
+static MemAddr os_firstFitWithin(Heap const *heap, uint16_t size, MemAddr addr, MemAddr end) {
+    for (uint16_t length; (length = os_nextFreeRun(heap, &addr, end)); addr += length) {
+        if (length >= size) {
+            return addr;
+        }
+    }
+    return 0;
+}
+
+/*!
+ *  Takes the first run of free chunks that is large enough.
+ *
+ *  \param heap The heap to search.
+ *  \param size The number of chunks needed.
+ *  \return The first chunk of the run or 0 if there is none.
+ */
+MemAddr os_Memory_FirstFit(Heap *heap, uint16_t size) {
+    return os_firstFitWithin(heap, size, os_getUseStart(heap), os_getUseStart(heap) + os_getUseSize(heap));
+}
+
+/*!
+ *  Takes the first run of free chunks that is large enough, starting behind
+ *  the previous allocation of this strategy and wrapping around at the end
+ *  of the heap.
+ *
+ *  \param heap The heap to search.
+ *  \param size The number of chunks needed.
+ *  \return The first chunk of the run or 0 if there is none.
+ */
+MemAddr os_Memory_NextFit(Heap *heap, uint16_t size) {
+    MemAddr const end = os_getUseStart(heap) + os_getUseSize(heap);
+    MemAddr addr = os_firstFitWithin(heap, size, heap->nextFit, end);
+    if (!addr) {
+        addr = os_firstFitWithin(heap, size, os_getUseStart(heap), end);
+    }
+    if (addr) {
+        heap->nextFit = addr + size;
+    }
+    return addr;
+}
+
+/*!
+ *  Takes the smallest run of free chunks that is large enough, the first
+ *  one of them if there are several.
+ *
+ *  \param heap The heap to search.
+ *  \param size The number of chunks needed.
+ *  \return The first chunk of the run or 0 if there is none.
+ */
+MemAddr os_Memory_BestFit(Heap *heap, uint16_t size) {
+    MemAddr const end = os_getUseStart(heap) + os_getUseSize(heap);
+    MemAddr best = 0;
+    uint16_t bestLength = UINT16_MAX;
+    MemAddr addr = os_getUseStart(heap);
+    for (uint16_t length; (length = os_nextFreeRun(heap, &addr, end)); addr += length) {
+        if (length >= size && length < bestLength) {
+            best = addr;
+            bestLength = length;
+            if (length == size) {
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+/*!
+ *  Takes the largest run of free chunks, the first one of them if there are
+ *  several.
+ *
+ *  \param heap The heap to search.
+ *  \param size The number of chunks needed.
+ *  \return The first chunk of the run or 0 if it is too small.
+ */
+MemAddr os_Memory_WorstFit(Heap *heap, uint16_t size) {
+    MemAddr const end = os_getUseStart(heap) + os_getUseSize(heap);
+    MemAddr worst = 0;
+    uint16_t worstLength = 0;
+    MemAddr addr = os_getUseStart(heap);
+    for (uint16_t length; (length = os_nextFreeRun(heap, &addr, end)); addr += length) {
+        if (length > worstLength) {
+            worst = addr;
+            worstLength = length;
+        }
+    }
+    return worstLength >= size ? worst : 0;
+}
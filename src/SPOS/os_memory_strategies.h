@@ -0,0 +1,31 @@
+/*! \file
+ *  \brief Strategies to find free heap memory.
+ *
+ *  Every strategy returns the first chunk of a run of at least size free
+ *  chunks, or 0 if there is none. The chunks are not marked allocated.
+ */
+
+#ifndef _OS_MEMORY_STRATEGIES_H
+#define _OS_MEMORY_STRATEGIES_H
+
+#include <stdint.h>
+
+#include "os_memheap_drivers.h"
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! The first free run that is large enough
+MemAddr os_Memory_FirstFit(Heap *heap, uint16_t size);
+
+//! The first free run that is large enough after the last allocation
+MemAddr os_Memory_NextFit(Heap *heap, uint16_t size);
+
+//! The smallest free run that is large enough
+MemAddr os_Memory_BestFit(Heap *heap, uint16_t size);
+
+//! The largest free run
+MemAddr os_Memory_WorstFit(Heap *heap, uint16_t size);
+
+#endif
@@ -0,0 +1,275 @@
+/*! \file
+ *  \brief Pipes between processes.
+ *
+ *  Every pipe is a ring buffer of PIPE_BUFFER_SIZE bytes from a static pool.
+ *  A process that has to wait for a pipe puts itself into the blocked state
+ *  and yields; the process on the other end unblocks it as soon as there is
+ *  something to read or room to write. The buffer is accessed within
+ *  critical sections only, so there may be any number of readers and writers.
+ */
+
+#include "os_pipe.h"
+
+#include "defines.h"
+#include "os_process.h"
+#include "os_scheduler.h"
+
+//----------------------------------------------------------------------------
+// Private types
+//----------------------------------------------------------------------------
+
+//! A pipe and the streams of both of its ends
+typedef struct Pipe {
+    uint8_t buffer[PIPE_BUFFER_SIZE];
+    uint8_t head;
+    uint8_t fill;
+    bool open;
+    ProcessMask waitingReaders;
+    ProcessMask waitingWriters;
+    FILE writer;
+    FILE reader;
+} Pipe;
+
+//----------------------------------------------------------------------------
+// Private function declarations
+//----------------------------------------------------------------------------
+
+//! Put function of the writing stream of a pipe
+static int os_putPipe(char c, FILE *stream);
+
+//! Get function of the reading stream of a pipe
+static int os_getPipe(FILE *stream);
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! The pool of pipes
+static Pipe pipes[MAX_NUMBER_OF_PIPES];
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Marks all pipes as closed. Called by os_init.
+ */
+void os_initPipes(void) {
+    for (PipeID pipe = 0; pipe < MAX_NUMBER_OF_PIPES; pipe++) {
+        pipes[pipe].open = false;
+    }
+}
+
+/*!
+ *  Takes an unused pipe from the pool and connects its streams.
+ *
+ *  \return The ID of the pipe or INVALID_PIPE if all pipes are in use.
+ */
+PipeID os_openPipe(void) {
+    os_enterCriticalSection();
+
+    PipeID pipe = 0;
+    while (pipe < MAX_NUMBER_OF_PIPES && pipes[pipe].open) {
+        pipe++;
+    }
+    if (pipe == MAX_NUMBER_OF_PIPES) {
+        os_leaveCriticalSection();
+        return INVALID_PIPE;
+    }
+
+    Pipe *const p = &pipes[pipe];
+    p->head = 0;
+    p->fill = 0;
+    p->open = true;
+    p->waitingReaders = 0;
+    p->waitingWriters = 0;
+    fdev_setup_stream(&p->writer, os_putPipe, NULL, _FDEV_SETUP_WRITE);
+    fdev_set_udata(&p->writer, p);
+    fdev_setup_stream(&p->reader, NULL, os_getPipe, _FDEV_SETUP_READ);
+    fdev_set_udata(&p->reader, p);
+
+    os_leaveCriticalSection();
+    return pipe;
+}
+
+/*!
+ *  Unblocks every process in the mask. Must be called within a critical section.
+ *
+ *  \param waiting The processes to wake up.
+ */
+static void os_wakeWaiting(ProcessMask waiting) {
+    for (ProcessID pid = 0; waiting; pid++, waiting >>= 1) {
+        if (waiting & 1) {
+            os_unblock(pid);
+        }
+    }
+}
+
+/*!
+ *  Blocks the calling process until someone wakes it up. The caller has
+ *  entered a critical section exactly once, which is left while waiting and
+ *  entered again before returning.
+ *
+ *  \param waiting The mask the calling process is added to.
+ */
+static void os_waitFor(ProcessMask *waiting) {
+    ProcessID const self = os_getCurrentProc();
+    *waiting |= 1 << self;
+    os_getProcessSlot(self)->state = OS_PS_BLOCKED;
+    os_leaveCriticalSection();
+    // Someone might have woken us between leaving the section and this check
+    if (os_getProcessSlot(self)->state == OS_PS_BLOCKED) {
+        os_yield();
+    }
+    os_enterCriticalSection();
+    *waiting &= ~(1 << self);
+}
+
+/*!
+ *  Removes a terminated process from the waiters of all pipes. Called with
+ *  the scheduler disabled.
+ *
+ *  \param pid The terminated process.
+ */
+void os_releaseProcessPipes(ProcessID pid) {
+    for (PipeID pipe = 0; pipe < MAX_NUMBER_OF_PIPES; pipe++) {
+        pipes[pipe].waitingReaders &= ~(1 << pid);
+        pipes[pipe].waitingWriters &= ~(1 << pid);
+    }
+}
+
+/*!
+ *  Closes a pipe. Waiting processes are woken up and see the pipe closed;
+ *  bytes that were not read yet are lost.
+ *
+ *  \param pipe The pipe to close.
+ */
+void os_closePipe(PipeID pipe) {
+    if (pipe >= MAX_NUMBER_OF_PIPES) {
+        return;
+    }
+
+    os_enterCriticalSection();
+    Pipe *const p = &pipes[pipe];
+    p->open = false;
+    os_wakeWaiting(p->waitingReaders | p->waitingWriters);
+    os_leaveCriticalSection();
+}
+
+/*!
+ *  Appends a byte to a pipe. If the pipe is full, the calling process is
+ *  blocked until a reader made room. Must not be called within a critical
+ *  section, as the scheduler could not switch to the reader then.
+ *
+ *  \param pipe The pipe to write to.
+ *  \param byte The byte to write.
+ *  \return False, iff the pipe is (or was meanwhile) closed.
+ */
+bool os_writePipe(PipeID pipe, uint8_t byte) {
+    if (pipe >= MAX_NUMBER_OF_PIPES) {
+        return false;
+    }
+
+    os_enterCriticalSection();
+    Pipe *const p = &pipes[pipe];
+    while (p->open && p->fill == PIPE_BUFFER_SIZE) {
+        os_waitFor(&p->waitingWriters);
+    }
+    if (!p->open) {
+        os_leaveCriticalSection();
+        return false;
+    }
+
+    p->buffer[(p->head + p->fill) % PIPE_BUFFER_SIZE] = byte;
+    p->fill++;
+    os_wakeWaiting(p->waitingReaders);
+    os_leaveCriticalSection();
+    return true;
+}
+
+/*!
+ *  Takes the oldest byte from a pipe. If the pipe is empty, the calling
+ *  process is blocked until a writer filled in something. Must not be called
+ *  within a critical section (see os_writePipe).
+ *
+ *  \param pipe The pipe to read from.
+ *  \return The byte read or -1 if the pipe is (or was meanwhile) closed.
+ */
+int16_t os_readPipe(PipeID pipe) {
+    if (pipe >= MAX_NUMBER_OF_PIPES) {
+        return -1;
+    }
+
+    os_enterCriticalSection();
+    Pipe *const p = &pipes[pipe];
+    while (p->open && p->fill == 0) {
+        os_waitFor(&p->waitingReaders);
+    }
+    if (!p->open) {
+        os_leaveCriticalSection();
+        return -1;
+    }
+
+    uint8_t const byte = p->buffer[p->head];
+    p->head = (p->head + 1) % PIPE_BUFFER_SIZE;
+    p->fill--;
+    os_wakeWaiting(p->waitingWriters);
+    os_leaveCriticalSection();
+    return byte;
+}
+
+/*!
+ *  A simple getter for the number of buffered bytes.
+ *
+ *  \param pipe The pipe to look at.
+ *  \return The number of bytes in the pipe (0 for closed pipes).
+ */
+uint8_t os_getPipeFill(PipeID pipe) {
+    if (pipe >= MAX_NUMBER_OF_PIPES) {
+        return 0;
+    }
+
+    os_enterCriticalSection();
+    uint8_t const fill = pipes[pipe].open ? pipes[pipe].fill : 0;
+    os_leaveCriticalSection();
+    return fill;
+}
+
+static int os_putPipe(char c, FILE *stream) {
+    Pipe *const p = fdev_get_udata(stream);
+    return os_writePipe(p - pipes, c) ? 0 : _FDEV_ERR;
+}
+
+static int os_getPipe(FILE *stream) {
+    Pipe *const p = fdev_get_udata(stream);
+    int16_t const byte = os_readPipe(p - pipes);
+    return byte < 0 ? _FDEV_EOF : byte;
+}
+
+/*!
+ *  Returns the stream for the writing end of a pipe, e.g. to be used with
+ *  fprintf or as the stdout of a process (see os_setProcessStream).
+ *
+ *  \param pipe An open pipe.
+ *  \return The stream or NULL if the pipe is not open.
+ */
+FILE *os_getPipeWriter(PipeID pipe) {
+    if (pipe >= MAX_NUMBER_OF_PIPES || !pipes[pipe].open) {
+        return NULL;
+    }
+    return &pipes[pipe].writer;
+}
+
+/*!
+ *  Returns the stream for the reading end of a pipe, e.g. to be used with
+ *  fgetc or fscanf.
+ *
+ *  \param pipe An open pipe.
+ *  \return The stream or NULL if the pipe is not open.
+ */
+FILE *os_getPipeReader(PipeID pipe) {
+    if (pipe >= MAX_NUMBER_OF_PIPES || !pipes[pipe].open) {
+        return NULL;
+    }
+    return &pipes[pipe].reader;
+}
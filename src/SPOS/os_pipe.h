@@ -0,0 +1,62 @@
+/*! \file
+ *  \brief Pipes between processes.
+ *
+ *  Contains bounded byte pipes that block readers while empty and writers
+ *  while full. Both ends are available as stdio streams.
+ */
+
+#ifndef _OS_PIPE_H
+#define _OS_PIPE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "os_process.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! The type for the ID of a pipe.
+typedef uint8_t PipeID;
+
+//----------------------------------------------------------------------------
+// Macros
+//----------------------------------------------------------------------------
+
+//! Returned by os_openPipe if no pipe is available
+#define INVALID_PIPE 255
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Closes all pipes
+void os_initPipes(void);
+
+//! Opens an empty pipe
+PipeID os_openPipe(void);
+
+//! Closes a pipe and wakes up all processes waiting for it
+void os_closePipe(PipeID pipe);
+
+//! Writes a byte into a pipe, waiting while it is full
+bool os_writePipe(PipeID pipe, uint8_t byte);
+
+//! Reads a byte from a pipe, waiting while it is empty
+int16_t os_readPipe(PipeID pipe);
+
+//! Number of bytes that can be read from a pipe without waiting
+uint8_t os_getPipeFill(PipeID pipe);
+
+//! The stream that writes into a pipe
+FILE *os_getPipeWriter(PipeID pipe);
+
+//! The stream that reads from a pipe
+FILE *os_getPipeReader(PipeID pipe);
+
+//! Removes a terminated process from the waiters of all pipes
+void os_releaseProcessPipes(ProcessID pid);
+
+#endif
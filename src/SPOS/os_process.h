@@ -14,15 +14,30 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "defines.h"
+
 //! The type for the ID of a running process.
 typedef uint8_t ProcessID;
 
+//! Bit mask with one bit per process (e.g. the processes waiting for something)
+typedef uint8_t ProcessMask;
+
+#if MAX_NUMBER_OF_PROCESSES > 8
+#error "ProcessMask is too small for MAX_NUMBER_OF_PROCESSES"
+#endif
+
 //! This is the type of a program function (not the pointer to one!).
 typedef void Program(void);
 
 //! The type of the priority of a process.
 typedef uint8_t Priority;
 
+//! The type for the ID of a process group.
+typedef uint8_t ProcessGroup;
+
+//! The CPU shares of a process group (scheduler specific property).
+typedef uint8_t Shares;
+
 //! The age of a process (scheduler specific property).
 typedef uint16_t Age;
 
@@ -56,6 +71,7 @@ typedef struct
     Program *program;
     Priority priority;
     StackChecksum checksum;
+    ProcessGroup group;
 
 } Process;
 
@@ -0,0 +1,154 @@
+/*! \file
+ *  \brief Registry of the programs known to the OS.
+ *
+ *  The registry is an array in flash, indexed by the program ID, so looking
+ *  up a program takes constant time and no RAM. The application defines it
+ *  with REGISTER_PROGRAMS, which overrides the empty default below.
+ */
+
+#include "os_programs.h"
+
+#include <string.h>
+
+#include "defines.h"
+#include "os_scheduler.h"
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Default for applications without REGISTER_PROGRAMS.
+ *
+ *  \return NULL, there is no registry.
+ */
+__attribute__((weak)) ProgramInfo const *os_getProgramRegistry(void) {
+    return NULL;
+}
+
+/*!
+ *  Default for applications without REGISTER_PROGRAMS.
+ *
+ *  \return 0, there are no registered programs.
+ */
+__attribute__((weak)) uint8_t os_getNumberOfRegisteredPrograms(void) {
+    return 0;
+}
+
+/*!
+ *  Copies the metadata of a registered program from flash.
+ *
+ *  \param id The ID of the program.
+ *  \param info Receives the metadata.
+ *  \return False, iff there is no program with the ID.
+ */
+bool os_getProgramInfo(ProgramID id, ProgramInfo *info) {
+    if (id >= os_getNumberOfRegisteredPrograms()) {
+        return false;
+    }
+    memcpy_P(info, &os_getProgramRegistry()[id], sizeof(ProgramInfo));
+    return true;
+}
+
+/*!
+ *  Returns the function of a registered program.
+ *
+ *  \param id The ID of the program.
+ *  \return The function or NULL if there is no program with the ID.
+ */
+Program *os_getProgramSlot(ProgramID id) {
+    if (id >= os_getNumberOfRegisteredPrograms()) {
+        return NULL;
+    }
+    return (Program *)pgm_read_word(&os_getProgramRegistry()[id].program);
+}
+
+/*!
+ *  Finds a registered program by its name.
+ *
+ *  \param name The name (in RAM) to look for.
+ *  \return The ID of the program or INVALID_PROGRAM.
+ */
+ProgramID os_lookupProgram(char const *name) {
+    ProgramInfo const *const registry = os_getProgramRegistry();
+    for (ProgramID id = 0; id < os_getNumberOfRegisteredPrograms(); id++) {
+        if (!strncmp_P(name, registry[id].name, PROGRAM_NAME_LENGTH + 1)) {
+            return id;
+        }
+    }
+    return INVALID_PROGRAM;
+}
+
+/*!
+ *  Finds the registry entry of a program function, e.g. to name the program
+ *  a process runs.
+ *
+ *  \param program The function of the program.
+ *  \return The ID of the program or INVALID_PROGRAM if it is not registered.
+ */
+ProgramID os_findProgram(Program *program) {
+    for (ProgramID id = 0; id < os_getNumberOfRegisteredPrograms(); id++) {
+        if (os_getProgramSlot(id) == program) {
+            return id;
+        }
+    }
+    return INVALID_PROGRAM;
+}
+
+/*!
+ *  Checks whether a process runs a registered program.
+ *
+ *  \param id The ID of the program.
+ *  \return True, iff there is a program with the ID and a process runs it.
+ */
+bool os_isProgramRunning(ProgramID id) {
+    Program *const program = os_getProgramSlot(id);
+    bool running = false;
+    os_enterCriticalSection();
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES && program; pid++) {
+        Process const *const process = os_getProcessSlot(pid);
+        running |= process->state != OS_PS_UNUSED && process->program == program;
+    }
+    os_leaveCriticalSection();
+    return running;
+}
+
+/*!
+ *  Starts a registered program with its default priority. Fails if the
+ *  program needs more stack than a process has, or if it is a singleton that
+ *  is already running. Programs flagged with OS_PF_SYSTEM are moved to
+ *  SYSTEM_GROUP, so they do not take shares from the application groups.
+ *
+ *  \param id The ID of the program.
+ *  \return The ID of the new process or INVALID_PROCESS.
+ */
+ProcessID os_execProgram(ProgramID id) {
+    ProgramInfo info;
+    if (!os_getProgramInfo(id, &info) || info.stackSize > STACK_SIZE_PROC) {
+        return INVALID_PROCESS;
+    }
+
+    os_enterCriticalSection();
+    if ((info.flags & OS_PF_SINGLETON) && os_isProgramRunning(id)) {
+        os_leaveCriticalSection();
+        return INVALID_PROCESS;
+    }
+    ProcessID const pid = os_exec(info.program, info.priority);
+    if (pid != INVALID_PROCESS && (info.flags & OS_PF_SYSTEM)) {
+        os_setProcessGroup(pid, SYSTEM_GROUP);
+    }
+    os_leaveCriticalSection();
+    return pid;
+}
+
+/*!
+ *  Starts every registered program flagged with OS_PF_AUTOSTART. Called by
+ *  os_initScheduler after the programs registered with REGISTER_AUTOSTART.
+ */
+void os_autostartPrograms(void) {
+    for (ProgramID id = 0; id < os_getNumberOfRegisteredPrograms(); id++) {
+        if (pgm_read_byte(&os_getProgramRegistry()[id].flags) & OS_PF_AUTOSTART) {
+            os_execProgram(id);
+        }
+    }
+}
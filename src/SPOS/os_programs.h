@@ -0,0 +1,120 @@
+/*! \file
+ *  \brief Registry of the programs known to the OS.
+ *
+ *  Contains a table in flash that lists the programs which can be started
+ *  by ID or name, e.g. from the task manager, together with their metadata.
+ */
+
+#ifndef _OS_PROGRAMS_H
+#define _OS_PROGRAMS_H
+
+#include <avr/pgmspace.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "os_process.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! The type for the ID of a registered program (its index in the registry).
+typedef uint8_t ProgramID;
+
+//! Flags of a registered program (see OS_PF_*)
+typedef uint8_t ProgramFlags;
+
+//! Maximum length of a program name
+#define PROGRAM_NAME_LENGTH 11
+
+//! Metadata of a registered program, stored in flash.
+typedef struct ProgramInfo {
+    Program *program;
+    char name[PROGRAM_NAME_LENGTH + 1];
+    Priority priority;
+    uint16_t stackSize;
+    ProgramFlags flags;
+} ProgramInfo;
+
+//----------------------------------------------------------------------------
+// Macros
+//----------------------------------------------------------------------------
+
+//! Returned if there is no program with a given name
+#define INVALID_PROGRAM 255
+
+//! The program is started by os_init
+#define OS_PF_AUTOSTART 0x01
+
+//! At most one process may run the program
+#define OS_PF_SINGLETON 0x02
+
+//! The program is not offered by the task manager
+#define OS_PF_HIDDEN 0x04
+
+//! The program is a system service and runs in SYSTEM_GROUP
+#define OS_PF_SYSTEM 0x08
+
+/*!
+ *  Describes a program for REGISTER_PROGRAMS.
+ *  NAME: a string literal of at most PROGRAM_NAME_LENGTH characters.
+ *  PROGRAM_FUNCTION: the function of the program.
+ *  PRIORITY: the priority os_execProgram starts the program with.
+ *  STACK: the stack the program needs in bytes (at most STACK_SIZE_PROC).
+ *  FLAGS: any combination of the OS_PF_* flags or 0.
+ */
+#define PROGRAM(NAME, PROGRAM_FUNCTION, PRIORITY, STACK, FLAGS) \
+    { .program = PROGRAM_FUNCTION, .name = NAME, .priority = PRIORITY, .stackSize = STACK, .flags = FLAGS }
+
+/*!
+ *  Defines the program registry of the application. Use it once, at file
+ *  scope, with one PROGRAM entry per program. The ID of a program is its
+ *  position in the list. Without it the registry is empty.
+ *
+ *    void blink(void);
+ *    REGISTER_PROGRAMS(
+ *        PROGRAM("blink", blink, DEFAULT_PRIORITY, 64, OS_PF_SINGLETON),
+ *        ...
+ *    )
+ */
+#define REGISTER_PROGRAMS(...)                                                \
+    static ProgramInfo const os_programRegistry[] PROGMEM = {__VA_ARGS__};   \
+    ProgramInfo const *os_getProgramRegistry(void) {                          \
+        return os_programRegistry;                                            \
+    }                                                                         \
+    uint8_t os_getNumberOfRegisteredPrograms(void) {                          \
+        return sizeof(os_programRegistry) / sizeof(os_programRegistry[0]);   \
+    }
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! The registry in flash, defined by REGISTER_PROGRAMS
+ProgramInfo const *os_getProgramRegistry(void);
+
+//! Number of programs in the registry
+uint8_t os_getNumberOfRegisteredPrograms(void);
+
+//! Copies the metadata of a program from flash
+bool os_getProgramInfo(ProgramID id, ProgramInfo *info);
+
+//! The function of a registered program
+Program *os_getProgramSlot(ProgramID id);
+
+//! Finds a program by its name
+ProgramID os_lookupProgram(char const *name);
+
+//! Finds the registry entry of a program function
+ProgramID os_findProgram(Program *program);
+
+//! Checks whether a process runs a registered program
+bool os_isProgramRunning(ProgramID id);
+
+//! Starts a registered program with its default priority
+ProcessID os_execProgram(ProgramID id);
+
+//! Starts the registered programs flagged with OS_PF_AUTOSTART
+void os_autostartPrograms(void);
+
+#endif
@@ -12,14 +12,26 @@
 #include "os_scheduler.h"
 
 #include <avr/interrupt.h>
+#include <avr/sleep.h>
 #include <stdbool.h>
 
 #include "lcd.h"
 #include "os_core.h"
 #include "os_input.h"
+#include "os_io.h"
+#include "os_log.h"
+#include "os_pipe.h"
+#include "os_programs.h"
 #include "os_scheduling_strategies.h"
+#include "os_stats.h"
 #include "os_taskman.h"
+#include "os_trace.h"
+#include "os_usart.h"
 #include "util.h"
+#if (VERSUCH >= 3)
+    #include "os_handles.h"
+    #include "os_memory.h"
+#endif
 
 //----------------------------------------------------------------------------
 // Private Types
@@ -35,6 +47,9 @@ Process os_processes[MAX_NUMBER_OF_PROCESSES];
 //! Index of process that is currently executed (default: idle)
 ProcessID currentProc;
 
+//! CPU shares of every process group
+Shares groupShares[MAX_NUMBER_OF_GROUPS];
+
 //----------------------------------------------------------------------------
 // Private variables
 //----------------------------------------------------------------------------
@@ -45,6 +60,39 @@ SchedulingStrategy currentStrategy;
 //! Count of currently nested critical sections
 uint8_t criticalSectionCount = 0;
 
+//! Set if a process the active strategy prefers became ready and is waiting for the scheduler
+volatile bool needResched = false;
+
+//! Scheduler calls per process group in the current usage window
+uint8_t groupTicks[MAX_NUMBER_OF_GROUPS];
+
+//! Scheduler calls in the current usage window
+uint8_t groupWindowTicks = 0;
+
+//! CPU usage per process group (in percent) measured in the last usage window
+uint8_t groupUsage[MAX_NUMBER_OF_GROUPS];
+
+//! Quantum of every process in microseconds, 0 meaning the scheduler tick
+uint16_t processTickPeriod[MAX_NUMBER_OF_PROCESSES];
+
+//! Compare value of timer 2 for the quantum of every process
+uint8_t processTickCompare[MAX_NUMBER_OF_PROCESSES];
+
+//! The buttons held at the last scheduler tick, to react on chords only once
+uint8_t lastChord = 0;
+
+//! Set when the scheduler is entered by a call instead of its interrupt
+bool softEntry = false;
+
+//! Cleared while the strategy is consulted for a call instead of the timer interrupt
+bool schedulerTick = true;
+
+//! The processes in os_sleep
+ProcessMask sleepers = 0;
+
+//! System time (see os_systemTime_augment) at which every sleeping process wakes up
+Time sleepDeadline[MAX_NUMBER_OF_PROCESSES];
+
 //----------------------------------------------------------------------------
 // Private function declarations
 //----------------------------------------------------------------------------
@@ -53,6 +101,21 @@ uint8_t criticalSectionCount = 0;
 ISR(TIMER2_COMPA_vect)
 __attribute__((naked));
 
+//! Accounts one scheduler call to the group of the given process
+static void os_accountGroupUsage(ProcessID pid);
+
+//! Makes a blocked process ready and notes whether it should preempt the running one
+static bool os_wakeUp(ProcessID pid);
+
+//! Reacts on the button chords of the OS
+static void os_handleChords(void);
+
+//! Frees the slot of a terminated process
+static void os_releaseProcess(ProcessID pid);
+
+//! Wakes up the sleeping processes whose time is up
+static void os_wakeSleepers(void);
+
 //----------------------------------------------------------------------------
 // Function definitions
 //----------------------------------------------------------------------------
@@ -69,19 +132,50 @@ ISR(TIMER2_COMPA_vect) {
     saveContext();
     os_getProcessSlot(currentProc)->sp.as_int = SP;
     SP = BOTTOM_OF_ISR_STACK;
-    os_getProcessSlot(currentProc)->state = OS_PS_READY;
+    // Timer 2 restarted at the compare match, so it counted the latency of the interrupt
+    schedulerTick = !softEntry;
+    if (schedulerTick) {
+        os_statsTickLatency(TCNT2);
+    }
+    softEntry = false;
+    os_trace(OS_TE_ISR_ENTER, OS_TI_SCHEDULER);
+    // A process that blocked itself before entering the scheduler stays blocked
+    if (os_getProcessSlot(currentProc)->state == OS_PS_RUNNING) {
+        os_getProcessSlot(currentProc)->state = OS_PS_READY;
+    }
     os_getProcessSlot(currentProc)->checksum = os_getStackChecksum(currentProc);
 
+    // Button presses may wake up or start a process, which can then be chosen right away
+    os_inputTick();
+    os_handleChords();
+    os_wakeSleepers();
+
+    needResched = false;
+    ProcessID const previousProc = currentProc;
     currentProc = (*os_getSchedulingStrategyFn())(os_processes, currentProc);
+    schedulerTick = true;
+    if (currentProc != previousProc) {
+        if (os_getProcessSlot(previousProc)->state == OS_PS_BLOCKED) {
+            os_trace(OS_TE_BLOCK, previousProc);
+        }
+        os_trace(OS_TE_SWITCH, currentProc);
+    }
+    os_accountGroupUsage(currentProc);
+    os_statsTick();
 
     os_getProcessSlot(currentProc)->state = OS_PS_RUNNING;
 
+    // Give the process its own quantum, restarting the timer if it already passed the new compare value
+    if (OCR2A != processTickCompare[currentProc]) {
+        OCR2A = processTickCompare[currentProc];
+        if (TCNT2 >= OCR2A) {
+            TCNT2 = 0;
+        }
+    }
+
+    os_trace(OS_TE_ISR_LEAVE, OS_TI_SCHEDULER);
     SP = os_getProcessSlot(currentProc)->sp.as_int;
 
-    if (os_getInput() == (0b00001000 | 0b00000001)) {
-        os_waitForNoInput();
-        os_taskManOpen();
-    }
     restoreContext();
 
     if (os_getProcessSlot(currentProc)->checksum != os_getStackChecksum(currentProc)) {
@@ -89,14 +183,36 @@ ISR(TIMER2_COMPA_vect) {
     }
 }
 
+/*!
+ *  Checks whether the buttons held changed to one of the chords of the OS:
+ *  ENTER and ESC open the task manager, UP and DOWN bring the next virtual
+ *  console to the foreground. Each chord is handled once when it is pressed.
+ */
+static void os_handleChords(void) {
+    uint8_t const input = os_getInput();
+    if (input == lastChord) {
+        return;
+    }
+    lastChord = input;
+
+    if (input == (0b00001000 | 0b00000001)) {
+        os_openTaskMan();
+    } else if (input == (0b00000100 | 0b00000010) && !os_taskManOpen()) {
+        lcd_switchConsole();
+    }
+}
+
 /*!
  *  This is the idle program. The idle process owns all the memory
- *  and processor time no other process wants to have.
+ *  and processor time no other process wants to have. It puts the processor
+ *  to sleep until the next interrupt, which either switches to another
+ *  process or lets the idle process sleep again.
  */
 void idle(void) {
-    lcd_clear();
-    lcd_writeProgString(PSTR("...."));
-    delayMs(DEFAULT_OUTPUT_DELAY);
+    while (1) {
+        set_sleep_mode(os_getIdleSleepMode());
+        sleep_mode();
+    }
 }
 
 SchedulingStrategyFn os_getSchedulingStrategyFn(void) {
@@ -125,6 +241,22 @@ SchedulingStrategyFn _schedulingStrategyFnFactory(SchedulingStrategy strategy) {
         case OS_SS_INACTIVE_AGING:
             currentStrategyFn = &os_Scheduler_InactiveAging;
             break;
+
+        case OS_SS_FAIR_SHARE:
+            currentStrategyFn = &os_Scheduler_FairShare;
+            break;
+
+        case OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE:
+            currentStrategyFn = &os_Scheduler_MLFQ;
+            break;
+
+        case OS_SS_COMPLETELY_FAIR:
+            currentStrategyFn = &os_Scheduler_CompletelyFair;
+            break;
+
+        case OS_SS_CYCLIC_EXECUTIVE:
+            currentStrategyFn = &os_Scheduler_CyclicExecutive;
+            break;
         default:
             currentStrategyFn = &os_Scheduler_Even;
             break;
@@ -150,43 +282,60 @@ SchedulingStrategyFn _schedulingStrategyFnFactory(SchedulingStrategy strategy) {
  *          defines.h on failure
  */
 ProcessID os_exec(Program *program, Priority priority) {
+    // Check programpointer validity
+    if (program == NULL) {
+        return INVALID_PROCESS;
+    }
+
     os_enterCriticalSection();
 
     // Find empty process slot
     ProcessID free_process_slot = 0;
     while (os_getProcessSlot(free_process_slot)->state != OS_PS_UNUSED) {
         free_process_slot++;
+        // if maximum amount of processes has been exceeded
         if (free_process_slot >= MAX_NUMBER_OF_PROCESSES) {
+            os_leaveCriticalSection();
             return INVALID_PROCESS;
         }
     }
 
-    // if maximum amount of processes has been exceeded
-
-    // Check programpointer validity
-    if (program == NULL) {
-        return INVALID_PROCESS;
-    }
-
     Process *empty_process = os_getProcessSlot(free_process_slot);
 
     empty_process->program = program;
     empty_process->priority = priority;
+    empty_process->group = DEFAULT_GROUP;
     empty_process->state = OS_PS_READY;
-
+    os_resetProcessSchedulingInformation(free_process_slot);
+    processTickPeriod[free_process_slot] = 0;
+    processTickCompare[free_process_slot] = os_getTickCompare(0);
+    os_boostClock(priority);
+    lcd_closeConsole(free_process_slot);
+    os_resetProcessStreams(free_process_slot);
+
+    os_paintStack(free_process_slot);
+    os_trace(OS_TE_EXEC, free_process_slot);
+    os_log("pid %u started at priority %u", free_process_slot, priority);
+
+    // The stack grows downwards: return address (low byte first) followed by SREG and the 32 registers
     StackPointer stack_pointer;
     stack_pointer.as_int = PROCESS_STACK_BOTTOM(free_process_slot);
 
+#if (VERSUCH >= 3)
+    // The dispatcher runs the program and terminates the process once it returns
+    uint16_t program_counter = (uint16_t)os_dispatcher;
+#else
     uint16_t program_counter = (uint16_t)program;
+#endif
     *stack_pointer.as_ptr = (uint8_t)program_counter;
-    stack_pointer.as_ptr++;
+    stack_pointer.as_ptr--;
 
-    *stack_pointer.as_ptr = (uint8_t)program_counter >> 8;
-    stack_pointer.as_ptr++;
+    *stack_pointer.as_ptr = (uint8_t)(program_counter >> 8);
+    stack_pointer.as_ptr--;
 
-    for (int i = 0; i < 33; i++) {
+    for (uint8_t i = 0; i < 33; i++) {
         *stack_pointer.as_ptr = 0x00;
-        stack_pointer.as_ptr++;
+        stack_pointer.as_ptr--;
     }
     empty_process->sp = stack_pointer;
     empty_process->checksum = os_getStackChecksum(free_process_slot);
@@ -196,6 +345,91 @@ ProcessID os_exec(Program *program, Priority priority) {
     return free_process_slot;
 }
 
+/*!
+ *  The function every process starts in: it runs the program of the process
+ *  and terminates the process when the program returns, so its slot, its
+ *  console and its heap memory are released like with os_exit.
+ */
+void os_dispatcher(void) {
+    Program *const program = os_getProcessSlot(os_getCurrentProc())->program;
+    program();
+    os_exit();
+}
+
+/*!
+ *  Terminates the calling process. Its slot can be used by os_exec again and
+ *  the scheduler switches to another process right away, so this function
+ *  does not return. Critical sections the process did not leave are left.
+ */
+void os_exit(void) {
+    cli();
+    ProcessID const self = currentProc;
+    if (self == 0) {
+        // The idle process has to stay
+        sei();
+        return;
+    }
+
+    os_releaseProcess(self);
+    criticalSectionCount = 0;
+    sbi(TIMSK2, OCIE2A);
+    softEntry = true;
+
+    // The scheduler keeps the slot unused and never returns here
+    TIMER2_COMPA_vect();
+}
+
+/*!
+ *  Terminates another process. It does not run again and its slot can be
+ *  used by os_exec again. A process that kills itself does not return, just
+ *  like with os_exit. Resources the process waited for are not notified, so
+ *  a process should not be killed while others depend on it.
+ *
+ *  \param pid The process to terminate.
+ *  \return True, iff the process existed and is not the idle process.
+ */
+bool os_kill(ProcessID pid) {
+    if (pid == 0 || pid >= MAX_NUMBER_OF_PROCESSES) {
+        return false;
+    }
+    if (pid == os_getCurrentProc()) {
+        os_exit();
+    }
+
+    os_enterCriticalSection();
+    bool const exists = os_processes[pid].state != OS_PS_UNUSED;
+    if (exists) {
+        os_releaseProcess(pid);
+    }
+    os_leaveCriticalSection();
+
+    return exists;
+}
+
+/*!
+ *  Marks the slot of a terminated process unused and releases what it held.
+ *  Must be called with the scheduler disabled.
+ *
+ *  \param pid The terminated process.
+ */
+static void os_releaseProcess(ProcessID pid) {
+    lcd_closeConsole(pid);
+    os_processes[pid].state = OS_PS_UNUSED;
+    sleepers &= ~(1 << pid);
+    os_releaseProcessInput(pid);
+    os_releaseProcessPipes(pid);
+    os_releaseProcessUsart(pid);
+    os_releaseProcessTaskMan(pid);
+#if (VERSUCH >= 3)
+    os_releaseProcessHandles(pid);
+    for (uint8_t i = 0; i < os_getHeapListLength(); i++) {
+        os_freeProcessMemory(os_lookupHeap(i), pid);
+    }
+#endif
+    os_trace(OS_TE_EXIT, pid);
+    os_log("pid %u ended", pid);
+}
+
 /*!
  *  If all processes have been registered for execution, the OS calls this
  *  function to start the idle program and the concurrent execution of the
@@ -214,6 +448,10 @@ void os_startScheduler(void) {
  *  initialize its internal data-structures and register.
  */
 void os_initScheduler(void) {
+    for (ProcessGroup group = 0; group < MAX_NUMBER_OF_GROUPS; group++) {
+        groupShares[group] = DEFAULT_GROUP_SHARES;
+    }
+
     // loop through autostart list
     ProcessID pid = 0;
 
@@ -223,6 +461,8 @@ void os_initScheduler(void) {
         pid = os_exec(node->program, DEFAULT_PRIORITY);
         os_processes[pid].state = OS_PS_READY;
     }
+
+    os_autostartPrograms();
 }
 
 /*!
@@ -263,6 +503,324 @@ SchedulingStrategy os_getSchedulingStrategy(void) {
     return currentStrategy;
 }
 
+/*!
+ *  Moves a process into another process group. The fair-share strategy first
+ *  divides the processor time among the groups according to their shares and
+ *  then among the processes within each group according to their priorities.
+ *
+ *  \param pid The process to move.
+ *  \param group The group the process will belong to.
+ *  \return True, iff the process exists and the group is valid.
+ */
+bool os_setProcessGroup(ProcessID pid, ProcessGroup group) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES || group >= MAX_NUMBER_OF_GROUPS) {
+        return false;
+    }
+
+    os_enterCriticalSection();
+    Process *process = os_getProcessSlot(pid);
+    bool const exists = process->state != OS_PS_UNUSED;
+    if (exists && process->group != group) {
+        process->group = group;
+        os_resetProcessSchedulingInformation(pid);
+    }
+    os_leaveCriticalSection();
+
+    return exists;
+}
+
+/*!
+ *  Changes the priority of a process. The scheduling information of the
+ *  process is reset, as e.g. its age was gathered with the old priority.
+ *
+ *  \param pid The process to change.
+ *  \param priority The new priority.
+ *  \return True, iff the process exists.
+ */
+bool os_setProcessPriority(ProcessID pid, Priority priority) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES) {
+        return false;
+    }
+
+    os_enterCriticalSection();
+    Process *process = os_getProcessSlot(pid);
+    bool const exists = process->state != OS_PS_UNUSED;
+    if (exists && process->priority != priority) {
+        process->priority = priority;
+        os_resetProcessSchedulingInformation(pid);
+        os_boostClock(priority);
+    }
+    os_leaveCriticalSection();
+
+    return exists;
+}
+
+/*!
+ *  Sets the CPU shares of a process group. A group with twice the shares of
+ *  another group receives twice the processor time, no matter how many
+ *  processes either of them contains.
+ *
+ *  \param group The group to configure.
+ *  \param shares The new shares of the group (at least 1).
+ *  \return True, iff the group is valid and the shares are not 0.
+ */
+bool os_setGroupShares(ProcessGroup group, Shares shares) {
+    if (group >= MAX_NUMBER_OF_GROUPS || shares == 0) {
+        return false;
+    }
+    groupShares[group] = shares;
+    return true;
+}
+
+/*!
+ *  A simple getter for the CPU shares of a process group.
+ *
+ *  \param group The group to look up.
+ *  \return The shares of the group or 0 if the group is invalid.
+ */
+Shares os_getGroupShares(ProcessGroup group) {
+    if (group >= MAX_NUMBER_OF_GROUPS) {
+        return 0;
+    }
+    return groupShares[group];
+}
+
+/*!
+ *  Returns the fraction of scheduler calls that went to a process group
+ *  during the last completed usage window (see GROUP_USAGE_WINDOW).
+ *  Time spent in the idle process is not accounted to any group.
+ *
+ *  \param group The group to look up.
+ *  \return The CPU usage of the group in percent.
+ */
+uint8_t os_getGroupUsage(ProcessGroup group) {
+    if (group >= MAX_NUMBER_OF_GROUPS) {
+        return 0;
+    }
+    return groupUsage[group];
+}
+
+/*!
+ *  Accounts one scheduler call to the group of the given process. Once the
+ *  usage window is full, the counts are converted to percentages and a new
+ *  window is started.
+ *
+ *  \param pid The process that was chosen by the scheduler.
+ */
+static void os_accountGroupUsage(ProcessID pid) {
+    if (pid != 0) {
+        groupTicks[os_getProcessSlot(pid)->group]++;
+    }
+
+    if (++groupWindowTicks < GROUP_USAGE_WINDOW) {
+        return;
+    }
+
+    for (ProcessGroup group = 0; group < MAX_NUMBER_OF_GROUPS; group++) {
+        groupUsage[group] = (uint16_t)groupTicks[group] * 100 / GROUP_USAGE_WINDOW;
+        groupTicks[group] = 0;
+    }
+    groupWindowTicks = 0;
+}
+
+/*!
+ *  Gives a process a quantum that differs from the scheduler tick, e.g. a
+ *  short one for a latency-sensitive process or a long one for a process that
+ *  computes a lot. The timer is reprogrammed whenever the process is switched
+ *  to. The quantum uses the prescaler of the scheduler tick, so it is clamped
+ *  to 1..256 counts of that prescaler (see os_setTickPeriod).
+ *
+ *  \param pid The process to configure.
+ *  \param microseconds The quantum of the process or 0 to use the scheduler tick.
+ *  \return True, iff the process exists.
+ */
+bool os_setProcessTickPeriod(ProcessID pid, uint16_t microseconds) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES) {
+        return false;
+    }
+
+    os_enterCriticalSection();
+    bool const exists = os_getProcessSlot(pid)->state != OS_PS_UNUSED;
+    if (exists) {
+        processTickPeriod[pid] = microseconds;
+        processTickCompare[pid] = os_getTickCompare(microseconds);
+    }
+    os_leaveCriticalSection();
+
+    return exists;
+}
+
+/*!
+ *  A simple getter for the quantum of a process.
+ *
+ *  \param pid The process to look up.
+ *  \return The quantum in microseconds or 0 if the process uses the scheduler tick.
+ */
+uint16_t os_getProcessTickPeriod(ProcessID pid) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES) {
+        return 0;
+    }
+    return processTickPeriod[pid];
+}
+
+/*!
+ *  Converts the quanta of all processes to compare values for the current
+ *  prescaler of the scheduler tick. Called by os_setTickPeriod.
+ */
+void os_refreshProcessTickPeriods(void) {
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        processTickCompare[pid] = os_getTickCompare(processTickPeriod[pid]);
+    }
+}
+
+/*!
+ *  Makes a blocked process ready. If the active strategy prefers it over the
+ *  running process, a rescheduling is requested.
+ *
+ *  \param pid The process to wake up.
+ *  \return True, iff the process was blocked.
+ */
+static bool os_wakeUp(ProcessID pid) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES) {
+        return false;
+    }
+
+    uint8_t const sreg = SREG;
+    cli();
+    bool const blocked = os_processes[pid].state == OS_PS_BLOCKED;
+    if (blocked) {
+        os_processes[pid].state = OS_PS_READY;
+        os_trace(OS_TE_WAKE, pid);
+        os_boostClock(os_processes[pid].priority);
+        if (os_isPreferred(os_processes, pid, currentProc)) {
+            needResched = true;
+        }
+    }
+    SREG = sreg;
+
+    return blocked;
+}
+
+/*!
+ *  Blocks the calling process for some time, leaving the processor to the
+ *  other processes. The scheduler wakes it up at the first tick after the
+ *  time is up. The idle process must not sleep, so it returns right away.
+ *  Must not be called within a critical section.
+ *
+ *  \param ms The time to sleep in milliseconds.
+ */
+void os_sleep(uint16_t ms) {
+    ProcessID const self = os_getCurrentProc();
+    if (ms == 0 || self == 0) {
+        return;
+    }
+
+    os_enterCriticalSection();
+    sleepDeadline[self] = os_systemTime_augment() + (Time)ms * TIME_COUNTS_PER_MS;
+    sleepers |= 1 << self;
+    while (sleepers & (1 << self)) {
+        os_processes[self].state = OS_PS_BLOCKED;
+        os_leaveCriticalSection();
+        // The scheduler might have woken us meanwhile
+        if (os_processes[self].state == OS_PS_BLOCKED) {
+            os_yield();
+        }
+        os_enterCriticalSection();
+    }
+    os_leaveCriticalSection();
+}
+
+/*!
+ *  Wakes up the sleeping processes whose time is up. Called by the scheduler.
+ */
+static void os_wakeSleepers(void) {
+    if (!sleepers) {
+        return;
+    }
+
+    Time const now = os_systemTime_augment();
+    for (ProcessID pid = 1; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        if ((sleepers & (1 << pid)) && (int32_t)(now - sleepDeadline[pid]) >= 0) {
+            sleepers &= ~(1 << pid);
+            os_wakeUp(pid);
+        }
+    }
+}
+
+/*!
+ *  Makes a blocked process ready again. If the active strategy prefers it over
+ *  the calling process, the processor is handed over right away instead of at
+ *  the next scheduler tick (or when the outermost critical section is left).
+ *
+ *  \param pid The process to wake up.
+ *  \return True, iff the process was blocked.
+ */
+bool os_unblock(ProcessID pid) {
+    bool const blocked = os_wakeUp(pid);
+    if (needResched) {
+        os_yield();
+    }
+    return blocked;
+}
+
+/*!
+ *  Variant of os_unblock for interrupt service routines. It only requests the
+ *  rescheduling, the ISR has to call os_reschedFromISR as its last statement
+ *  for the switch to happen before the interrupted process continues.
+ *
+ *  \param pid The process to wake up.
+ *  \return True, iff the process was blocked.
+ */
+bool os_unblockFromISR(ProcessID pid) {
+    return os_wakeUp(pid);
+}
+
+/*!
+ *  Performs a rescheduling requested by os_unblockFromISR. Must be the last
+ *  statement of an ISR (which runs with interrupts disabled): the scheduler
+ *  saves the state of the ISR along with the interrupted process and the rest
+ *  of the ISR is executed once the process is switched to again.
+ */
+void os_reschedFromISR(void) {
+    if (needResched && criticalSectionCount == 0) {
+        softEntry = true;
+        TIMER2_COMPA_vect();
+    }
+}
+
+/*!
+ *  Tells the strategies whether the scheduler was entered by its timer. It
+ *  was not if the current process gave up the processor itself (os_yield,
+ *  os_exit, blocking) or was preempted by a process woken in an ISR (see
+ *  os_reschedFromISR). Outside of the scheduler this is true, so a strategy
+ *  called directly behaves as on a timer tick.
+ *
+ *  \return True, iff the scheduler call is a timer tick.
+ */
+bool os_isSchedulerTick(void) {
+    return schedulerTick;
+}
+
+/*!
+ *  Hands the processor over to the scheduler before the time slice of the
+ *  calling process is used up. Inside a critical section or with interrupts
+ *  disabled the switch is deferred: leaving the outermost critical section
+ *  yields then, otherwise the next scheduler tick takes care of it.
+ */
+void os_yield(void) {
+    uint8_t const sreg = SREG;
+    cli();
+    if (criticalSectionCount > 0 || !(sreg & _BV(SREG_I))) {
+        needResched = true;
+        SREG = sreg;
+        return;
+    }
+
+    // Enter the scheduler as if its interrupt fired, it returns with interrupts enabled
+    softEntry = true;
+    TIMER2_COMPA_vect();
+}
+
 /*!
  *  Enters a critical code section by disabling the scheduler if needed.
  *  This function stores the nesting depth of critical sections of the current
@@ -271,33 +829,54 @@ SchedulingStrategy os_getSchedulingStrategy(void) {
  *  This function supports up to 255 nested critical sections.
  */
 void os_enterCriticalSection(void) {
-    uint8_t global_interrupt_enable_bit = (SREG & (1 << 7)) >> SREG;
-    SREG &= 0b10000000;
+    uint8_t const sreg = SREG;
+    cli();
     criticalSectionCount++;
-
-    // TODO: OCIE2A bit im Register TIMSK2 auf 0 setzen
-    SREG |= global_interrupt_enable_bit;
+    cbi(TIMSK2, OCIE2A);
+    os_statsCriticalSectionEntered(criticalSectionCount);
+    if (criticalSectionCount == 1) {
+        os_trace(OS_TE_CRITICAL_ENTER, currentProc);
+    }
+    SREG = sreg;
 }
 
 /*!
  *  Leaves a critical code section by enabling the scheduler if needed.
  *  This function utilizes the nesting depth of critical sections
  *  stored by os_enterCriticalSection to check if the scheduler
- *  has to be reactivated.
+ *  has to be reactivated. A rescheduling requested within the section
+ *  is performed when the outermost section is left.
  */
 void os_leaveCriticalSection(void) {
-    if (criticalSectionCount <= 0) {
-        criticalSectionCount = 0;
+    uint8_t const sreg = SREG;
+    cli();
+    if (criticalSectionCount == 0) {
+        SREG = sreg;
         return;
     }
-    uint8_t global_interrupt_enable_bit = (SREG & (1 << 7)) >> SREG;
-    SREG &= 0b10000000;
+
     criticalSectionCount--;
+    bool const leftOutermost = criticalSectionCount == 0;
+    if (leftOutermost) {
+        sbi(TIMSK2, OCIE2A);
+        os_statsCriticalSectionLeft();
+        os_trace(OS_TE_CRITICAL_LEAVE, currentProc);
+    }
+    SREG = sreg;
 
-    if (criticalSectionCount == 0) {
-        // TODO: OCIE2A bit im Register TIMSK2 auf 1 setzen
+    if (leftOutermost && needResched) {
+        os_yield();
     }
-    SREG |= global_interrupt_enable_bit;
+}
+
+/*!
+ *  Tells whether the current process is inside a critical section. It then
+ *  cannot be switched out, so it must not wait for other processes.
+ *
+ *  \return True, iff the scheduler is disabled by a critical section.
+ */
+bool os_isInCriticalSection(void) {
+    return criticalSectionCount > 0;
 }
 
 /*!
@@ -26,7 +26,11 @@ typedef enum SchedulingStrategy {
     OS_SS_RANDOM,
     OS_SS_RUN_TO_COMPLETION,
     OS_SS_ROUND_ROBIN,
-    OS_SS_INACTIVE_AGING
+    OS_SS_INACTIVE_AGING,
+    OS_SS_FAIR_SHARE,
+    OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE,
+    OS_SS_COMPLETELY_FAIR,
+    OS_SS_CYCLIC_EXECUTIVE
 } SchedulingStrategy;
 
 typedef ProcessID (*SchedulingStrategyFn)(Process const processes[], ProcessID current);
@@ -43,8 +47,14 @@ void os_startScheduler(void);
 //! Executes a process by instantiating a program
 ProcessID os_exec(Program program, Priority priority);
 
-//! Returns the number of programs
-uint8_t os_getNumberOfRegisteredPrograms(void);
+//! Terminates the calling process
+void os_exit(void);
+
+//! Runs the program of the calling process and terminates the process afterwards
+void os_dispatcher(void);
+
+//! Terminates a process
+bool os_kill(ProcessID pid);
 
 //! Initializes scheduler arrays
 void os_initScheduler(void);
@@ -61,6 +71,60 @@ SchedulingStrategy os_getSchedulingStrategy(void);
 //! Calculates the checksum of the stack for the corresponding process of pid.
 StackChecksum os_getStackChecksum(ProcessID pid);
 
+//! Changes the priority of a process
+bool os_setProcessPriority(ProcessID pid, Priority priority);
+
+//----------------------------------------------------------------------------
+// Process group management
+//----------------------------------------------------------------------------
+
+//! Moves a process into a process group
+bool os_setProcessGroup(ProcessID pid, ProcessGroup group);
+
+//! Sets the CPU shares of a process group
+bool os_setGroupShares(ProcessGroup group, Shares shares);
+
+//! Gets the CPU shares of a process group
+Shares os_getGroupShares(ProcessGroup group);
+
+//! Gets the CPU usage of a process group in percent
+uint8_t os_getGroupUsage(ProcessGroup group);
+
+//----------------------------------------------------------------------------
+// Rescheduling
+//----------------------------------------------------------------------------
+
+//! Hands the processor over to the scheduler before the time slice is used up
+void os_yield(void);
+
+//! Whether the scheduler was entered by its timer rather than by a call
+bool os_isSchedulerTick(void);
+
+//! Makes a blocked process ready and switches to it if the active strategy prefers it
+bool os_unblock(ProcessID pid);
+
+//! Makes a blocked process ready from within an ISR (see os_reschedFromISR)
+bool os_unblockFromISR(ProcessID pid);
+
+//! Switches to a process woken by os_unblockFromISR, to be called at the end of the ISR
+void os_reschedFromISR(void);
+
+//! Blocks the calling process for some milliseconds
+void os_sleep(uint16_t ms);
+
+//----------------------------------------------------------------------------
+// Tick management
+//----------------------------------------------------------------------------
+
+//! Gives a process a quantum that differs from the scheduler tick
+bool os_setProcessTickPeriod(ProcessID pid, uint16_t microseconds);
+
+//! Gets the quantum of a process in microseconds (0 meaning the scheduler tick)
+uint16_t os_getProcessTickPeriod(ProcessID pid);
+
+//! Converts the process quanta after the prescaler of the scheduler tick changed
+void os_refreshProcessTickPeriods(void);
+
 //----------------------------------------------------------------------------
 // Critical section management
 //----------------------------------------------------------------------------
@@ -71,6 +135,9 @@ void os_enterCriticalSection(void);
 //! Leaves a critical code section
 void os_leaveCriticalSection(void);
 
+//! Whether the current process is inside a critical section
+bool os_isInCriticalSection(void);
+
 SchedulingStrategyFn os_getSchedulingStrategyFn(void);
 
 SchedulingStrategyFn _schedulingStrategyFnFactory(SchedulingStrategy strategy);
@@ -3,12 +3,16 @@
 Scheduling strategies used by the Interrupt Service RoutineA from Timer 2 (in scheduler.c)
 to determine which process may continue its execution next.
 
-The file contains five strategies:
+The file contains nine strategies:
 -even
 -random
 -round-robin
 -inactive-aging
 -run-to-completion
+-fair-share
+-multi-level-feedback-queue
+-completely-fair
+-cyclic-executive
 */
 
 #include "os_scheduling_strategies.h"
@@ -17,15 +21,89 @@ The file contains five strategies:
 
 #include "defines.h"
 
+/*!
+ *  The pass of a process or group advances by STRIDE_BASE divided by its
+ *  weight every time it is chosen. The value is small enough that passes
+ *  never drift more than half the range of an uint16_t apart.
+ */
+#define STRIDE_BASE 0x1000
+
+//! Scheduling information of every process slot
+SchedulingInformation schedulingInfo[MAX_NUMBER_OF_PROCESSES];
+
+//! Virtual time of every process group (fair-share strategy)
+static uint16_t groupPass[MAX_NUMBER_OF_GROUPS];
+
+//! Pass of the process most recently chosen within each group (fair-share strategy)
+static uint16_t groupLastPass[MAX_NUMBER_OF_GROUPS];
+
+//! Pass of the group most recently chosen (fair-share strategy)
+static uint16_t globalPass;
+
+//! Bit set of processes that were runnable at the last call (fair-share strategy)
+static uint8_t runnableProcs;
+
+//! Bit set of groups that had runnable processes at the last call (fair-share strategy)
+static uint8_t runnableGroups;
+
+//! Scheduler calls since all processes were last moved to the top queue (MLFQ strategy)
+static uint8_t mlfqBoostTicks;
+
+//! Counts how often processes were appended to a queue, used to keep each queue in FIFO order (MLFQ strategy)
+static uint8_t mlfqEnqueueCount;
+
+//! The quantum of an MLFQ level in scheduler calls
+#define MLFQ_QUANTUM(LEVEL) (1 << (LEVEL))
+
+/*!
+ *  The virtual runtime of a process advances by VRUNTIME_SCALE divided by
+ *  its weight for every scheduler call it receives.
+ */
+#define VRUNTIME_SCALE 0xFFFF
+
+//! Smallest virtual runtime of all runnable processes, never decreases (completely-fair strategy)
+static uint32_t minVruntime;
+
+//! The minor frame of the cyclic schedule to run next (cyclic-executive strategy)
+static uint8_t cyclicFrame;
+
+//! The process of the running minor frame (cyclic-executive strategy)
+static ProcessID cyclicOwner;
+
+//! Default cyclic schedule that leaves the processor to idle, replaced by REGISTER_CYCLIC_SCHEDULE
+CyclicSchedule const os_cyclicSchedule PROGMEM __attribute__((weak)) = {.length = 1};
+
+//! Resets the scheduling information of a process slot for the given strategy
+static void resetProcessInformation(ProcessID id, SchedulingStrategy strategy);
+
+//! Appends a process to a queue of the MLFQ strategy
+static void mlfqSetLevel(ProcessID pid, uint8_t level);
+
+//! Compares two virtual runtimes of the completely-fair strategy
+static bool vruntimeBefore(uint32_t a, uint32_t b);
+
 /*!
  *  Reset the scheduling information for a specific strategy
- *  This is only relevant for RoundRobin and InactiveAging
- *  and is done when the strategy is changed through os_setSchedulingStrategy
+ *  This is done when the strategy is changed through os_setSchedulingStrategy
  *
  *  \param strategy  The strategy to reset information for
  */
 void os_resetSchedulingInformation(SchedulingStrategy strategy) {
-    // This is a presence task
+    minVruntime = 0;
+    mlfqEnqueueCount = 0;
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        resetProcessInformation(pid, strategy);
+    }
+
+    for (ProcessGroup group = 0; group < MAX_NUMBER_OF_GROUPS; group++) {
+        groupPass[group] = 0;
+        groupLastPass[group] = 0;
+    }
+    globalPass = 0;
+    runnableGroups = 0;
+    mlfqBoostTicks = 0;
+    cyclicFrame = 0;
+    cyclicOwner = 0;
 }
 
 /*!
@@ -36,7 +114,87 @@ void os_resetSchedulingInformation(SchedulingStrategy strategy) {
  *  \param id  The process slot to erase state for
  */
 void os_resetProcessSchedulingInformation(ProcessID id) {
-    // This is a presence task
+    resetProcessInformation(id, os_getSchedulingStrategy());
+}
+
+/*!
+ *  Tells whether the active strategy would run a process that just became
+ *  ready instead of the current one. This decides whether waking the process
+ *  preempts the current one right away or waits for the next scheduler tick.
+ *  The strategies are not called for this, as they update their information
+ *  on every call.
+ *
+ *  \param processes An array holding the processes.
+ *  \param candidate The process that became ready.
+ *  \param current The id of the currently running process.
+ *  \return True, iff the candidate should run now.
+ */
+bool os_isPreferred(Process const processes[], ProcessID candidate, ProcessID current) {
+    SchedulingStrategy const strategy = os_getSchedulingStrategy();
+
+    // The cyclic executive only runs processes in their own minor frames
+    if (candidate == current || strategy == OS_SS_CYCLIC_EXECUTIVE) {
+        return false;
+    }
+    if (current == 0 || !os_isRunnable(&processes[current])) {
+        return true;
+    }
+
+    switch (strategy) {
+        case OS_SS_RUN_TO_COMPLETION:
+            return false;
+
+        case OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE:
+            return schedulingInfo[candidate].mlfq.level < schedulingInfo[current].mlfq.level;
+
+        case OS_SS_COMPLETELY_FAIR:
+            return vruntimeBefore(schedulingInfo[candidate].vruntime, schedulingInfo[current].vruntime);
+
+        case OS_SS_INACTIVE_AGING:
+            return processes[candidate].priority > processes[current].priority;
+
+        case OS_SS_FAIR_SHARE:
+            // Between groups the shares decide, which only the next tick weighs
+            return processes[candidate].group == processes[current].group
+                && processes[candidate].priority > processes[current].priority;
+
+        default:
+            // Even, random and round robin do not order processes by priority
+            return false;
+    }
+}
+
+/*!
+ *  Initializes the scheduling information of a process slot as expected by
+ *  the given strategy.
+ *
+ *  \param id  The process slot to erase state for
+ *  \param strategy  The strategy the information is meant for
+ */
+static void resetProcessInformation(ProcessID id, SchedulingStrategy strategy) {
+    SchedulingInformation *const info = &schedulingInfo[id];
+    *info = (SchedulingInformation){0};
+
+    switch (strategy) {
+        case OS_SS_ROUND_ROBIN:
+            info->timeSlice = os_getProcessSlot(id)->priority;
+            break;
+
+        case OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE:
+            mlfqSetLevel(id, 0);
+            break;
+
+        case OS_SS_COMPLETELY_FAIR:
+            // New processes start at the current minimum so they cannot monopolize the processor
+            info->vruntime = minVruntime;
+            break;
+
+        default:
+            break;
+    }
+
+    // Let the fair-share strategy treat the slot as a newly joined process
+    runnableProcs &= ~(1 << id);
 }
 
 /*!
@@ -86,22 +244,26 @@ ProcessID os_Scheduler_Random(Process const processes[], ProcessID current) {
     return result;
 }
 
+/*!
+ *  Searches the process table for the next runnable process, starting after
+ *  the current one and wrapping around. The idle process is skipped, so it is
+ *  only returned if no other process is runnable.
+ *
+ *  \param processes An array holding the processes to search.
+ *  \param current The id of the process to start searching after.
+ *  \param direction 1 to search upwards, -1 to search downwards.
+ *  \return The next runnable process or 0 if there is none.
+ */
 ProcessID find_next_ready_process(Process const processes[], ProcessID current, int direction) {
-    ProcessID result = current;
-    for (ProcessID i = current + direction; i != current; i += direction) {
-        if (i >= MAX_NUMBER_OF_PROCESSES) {
-            i = 0;
-        } else if (i < 0) {
-            i = MAX_NUMBER_OF_PROCESSES - 1;
-        }
-
-        if (processes[i].state == OS_PS_READY) {
-            result = i;
-            break;
+    ProcessID pid = current;
+    for (uint8_t i = 0; i < MAX_NUMBER_OF_PROCESSES; i++) {
+        pid = (pid + MAX_NUMBER_OF_PROCESSES + direction) % MAX_NUMBER_OF_PROCESSES;
+        if (pid != 0 && os_isRunnable(&processes[pid])) {
+            return pid;
         }
     }
 
-    return result;
+    return 0;
 }
 
 /*!
@@ -116,8 +278,14 @@ ProcessID find_next_ready_process(Process const processes[], ProcessID current,
  *  \return The next process to be executed determined on the basis of the round robin strategy.
  */
 ProcessID os_Scheduler_RoundRobin(Process const processes[], ProcessID current) {
-    // This is a presence task
-    return 0;
+    if (current != 0 && os_isRunnable(&processes[current]) && schedulingInfo[current].timeSlice > 1) {
+        schedulingInfo[current].timeSlice--;
+        return current;
+    }
+
+    ProcessID const next = os_Scheduler_Even(processes, current);
+    schedulingInfo[next].timeSlice = processes[next].priority;
+    return next;
 }
 
 /*!
@@ -132,8 +300,27 @@ ProcessID os_Scheduler_RoundRobin(Process const processes[], ProcessID current)
  *  \return The next process to be executed, determined based on the inactive-aging strategy.
  */
 ProcessID os_Scheduler_InactiveAging(Process const processes[], ProcessID current) {
-    // This is a presence task
-    return 0;
+    ProcessID oldest = 0;
+
+    // Age the waiting processes and find the oldest one in the same pass
+    for (ProcessID pid = 1; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        if (!os_isRunnable(&processes[pid])) {
+            continue;
+        }
+        if (pid != current) {
+            schedulingInfo[pid].age += processes[pid].priority;
+        }
+        if (!oldest
+            || schedulingInfo[pid].age > schedulingInfo[oldest].age
+            || (schedulingInfo[pid].age == schedulingInfo[oldest].age && processes[pid].priority > processes[oldest].priority)) {
+            oldest = pid;
+        }
+    }
+
+    if (oldest) {
+        schedulingInfo[oldest].age = processes[oldest].priority;
+    }
+    return oldest;
 }
 
 /*!
@@ -146,6 +333,255 @@ ProcessID os_Scheduler_InactiveAging(Process const processes[], ProcessID curren
  *  \return The next process to be executed, determined based on the run-to-completion strategy.
  */
 ProcessID os_Scheduler_RunToCompletion(Process const processes[], ProcessID current) {
-    // This is a presence task
-    return 0;
+    if (current != 0 && os_isRunnable(&processes[current])) {
+        return current;
+    }
+    return os_Scheduler_Even(processes, current);
+}
+
+/*!
+ *  Compares two passes of the stride scheduler while tolerating overflows.
+ *
+ *  \param a The first pass.
+ *  \param b The second pass.
+ *  \return True, iff a lies before b.
+ */
+static bool passBefore(uint16_t a, uint16_t b) {
+    return (int16_t)(a - b) < 0;
+}
+
+/*!
+ *  This function realizes the hierarchical fair-share strategy. The processor time is divided
+ *  among the process groups in proportion to their shares first, and among the processes within
+ *  the chosen group in proportion to their priorities second. Both levels use stride scheduling:
+ *  every group and process has a pass that advances inversely to its weight whenever it is
+ *  chosen, and the one with the smallest pass wins. Thus a group cannot gain processor time by
+ *  starting more processes. Groups and processes that become runnable start at the pass of the
+ *  most recent choice on their level, so waiting does not earn them credit.
+ *  The idle process is only chosen if no other process is runnable.
+ *
+ *  \param processes An array holding the processes to choose the next process from.
+ *  \param current The id of the current process.
+ *  \return The next process to be executed, determined based on the fair-share strategy.
+ */
+ProcessID os_Scheduler_FairShare(Process const processes[], ProcessID current) {
+    uint8_t procs = 0;
+    uint8_t groups = 0;
+
+    for (ProcessID pid = 1; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        if (os_isRunnable(&processes[pid]) && processes[pid].group < MAX_NUMBER_OF_GROUPS) {
+            procs |= 1 << pid;
+            groups |= 1 << processes[pid].group;
+        }
+    }
+
+    uint8_t const joinedProcs = procs & ~runnableProcs;
+    uint8_t const joinedGroups = groups & ~runnableGroups;
+    runnableProcs = procs;
+    runnableGroups = groups;
+
+    if (!procs) {
+        return 0;
+    }
+
+    // Choose the group with the smallest pass
+    ProcessGroup group = MAX_NUMBER_OF_GROUPS;
+    for (ProcessGroup g = 0; g < MAX_NUMBER_OF_GROUPS; g++) {
+        if (!(groups & (1 << g))) {
+            continue;
+        }
+        if (joinedGroups & (1 << g)) {
+            groupPass[g] = globalPass;
+        }
+        if (group == MAX_NUMBER_OF_GROUPS || passBefore(groupPass[g], groupPass[group])) {
+            group = g;
+        }
+    }
+
+    // Choose the process with the smallest pass within that group
+    ProcessID next = 0;
+    for (ProcessID pid = 1; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        if (!(procs & (1 << pid))) {
+            continue;
+        }
+        if (joinedProcs & (1 << pid)) {
+            schedulingInfo[pid].pass = groupLastPass[processes[pid].group];
+        }
+        if (processes[pid].group != group) {
+            continue;
+        }
+        if (!next || passBefore(schedulingInfo[pid].pass, schedulingInfo[next].pass)) {
+            next = pid;
+        }
+    }
+
+    Shares shares = os_getGroupShares(group);
+    globalPass = groupPass[group];
+    groupPass[group] += STRIDE_BASE / (shares ? shares : 1);
+    groupLastPass[group] = schedulingInfo[next].pass;
+    schedulingInfo[next].pass += STRIDE_BASE / ((uint16_t)processes[next].priority + 1);
+
+    return next;
+}
+
+/*!
+ *  Appends a process to the end of a queue of the MLFQ strategy and grants
+ *  it a fresh quantum of that queue.
+ *
+ *  \param pid The process to move.
+ *  \param level The queue to move the process to.
+ */
+static void mlfqSetLevel(ProcessID pid, uint8_t level) {
+    schedulingInfo[pid].mlfq.level = level;
+    schedulingInfo[pid].mlfq.slice = MLFQ_QUANTUM(level);
+    schedulingInfo[pid].mlfq.enqueued = mlfqEnqueueCount++;
+}
+
+/*!
+ *  Checks whether a process lies before another one in the queues of the
+ *  MLFQ strategy, i.e. it is in a higher queue or was appended to the same
+ *  queue earlier.
+ *
+ *  \param a The first process.
+ *  \param b The second process.
+ *  \return True, iff a is to be scheduled before b.
+ */
+static bool mlfqBefore(ProcessID a, ProcessID b) {
+    if (schedulingInfo[a].mlfq.level != schedulingInfo[b].mlfq.level) {
+        return schedulingInfo[a].mlfq.level < schedulingInfo[b].mlfq.level;
+    }
+    return (int8_t)(schedulingInfo[a].mlfq.enqueued - schedulingInfo[b].mlfq.enqueued) < 0;
+}
+
+/*!
+ *  This function realizes the multi-level feedback queue strategy. Every process sits in one of
+ *  MLFQ_LEVELS queues, each with twice the quantum of the one above. A process that uses up its
+ *  whole quantum is moved down one queue, while a process that blocks before its quantum ends is
+ *  moved up one queue. Hence I/O-bound processes gather at the top and are favoured over CPU-bound
+ *  ones without manual priority tuning. The current process keeps the processor until its quantum
+ *  ends or a process in a higher queue becomes runnable. Otherwise the runnable process at the
+ *  front of the highest non-empty queue is chosen, so every queue is served round robin.
+ *  To prevent starvation, all processes are moved back to the top queue every MLFQ_BOOST_PERIOD
+ *  calls. Only timer ticks use up quanta and count towards the boost; a process that yields is
+ *  appended to its queue again and always gives up the processor to the others in that queue.
+ *  The idle process is only chosen if no other process is runnable.
+ *
+ *  \param processes An array holding the processes to choose the next process from.
+ *  \param current The id of the current process.
+ *  \return The next process to be executed, determined based on the MLFQ strategy.
+ */
+ProcessID os_Scheduler_MLFQ(Process const processes[], ProcessID current) {
+    SchedulingInformation *const info = &schedulingInfo[current];
+    bool keepCurrent = false;
+
+    bool const tick = os_isSchedulerTick();
+
+    if (current != 0) {
+        if (processes[current].state == OS_PS_BLOCKED) {
+            // Blocked before its quantum ended
+            mlfqSetLevel(current, info->mlfq.level ? info->mlfq.level - 1 : 0);
+        } else if (!tick) {
+            // Gave up the processor, it keeps the rest of its quantum for its next turn
+            info->mlfq.enqueued = mlfqEnqueueCount++;
+        } else if (--info->mlfq.slice == 0) {
+            // Used its full quantum
+            mlfqSetLevel(current, (info->mlfq.level + 1 < MLFQ_LEVELS) ? info->mlfq.level + 1 : info->mlfq.level);
+        } else {
+            keepCurrent = os_isRunnable(&processes[current]);
+        }
+    }
+
+    if (tick && ++mlfqBoostTicks >= MLFQ_BOOST_PERIOD) {
+        mlfqBoostTicks = 0;
+        for (ProcessID pid = 1; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+            mlfqSetLevel(pid, 0);
+        }
+    }
+
+    // Find the front of the highest queue with a runnable process
+    ProcessID next = 0;
+    for (ProcessID pid = 1; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        if (os_isRunnable(&processes[pid]) && (!next || mlfqBefore(pid, next))) {
+            next = pid;
+        }
+    }
+
+    if (keepCurrent && (!next || schedulingInfo[current].mlfq.level <= schedulingInfo[next].mlfq.level)) {
+        return current;
+    }
+    return next;
+}
+
+/*!
+ *  Compares two virtual runtimes while tolerating overflows.
+ *
+ *  \param a The first virtual runtime.
+ *  \param b The second virtual runtime.
+ *  \return True, iff a lies before b.
+ */
+static bool vruntimeBefore(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+/*!
+ *  This function realizes the completely-fair strategy. Every process accumulates a virtual
+ *  runtime that grows by VRUNTIME_SCALE / (priority + 1) for every scheduler call it receives,
+ *  and the runnable process with the smallest virtual runtime is chosen. In the long run, the
+ *  processor time of each process is therefore proportional to its priority plus one.
+ *  Processes that were blocked or newly started are lifted to the smallest virtual runtime of
+ *  the runnable processes, so they cannot monopolize the processor to catch up.
+ *  With at most MAX_NUMBER_OF_PROCESSES processes, a linear scan of the process table finds
+ *  the minimum faster than keeping a heap up to date.
+ *  The idle process is only chosen if no other process is runnable.
+ *
+ *  \param processes An array holding the processes to choose the next process from.
+ *  \param current The id of the current process.
+ *  \return The next process to be executed, determined based on the completely-fair strategy.
+ */
+ProcessID os_Scheduler_CompletelyFair(Process const processes[], ProcessID current) {
+    ProcessID next = 0;
+    for (ProcessID pid = 1; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        if (!os_isRunnable(&processes[pid])) {
+            continue;
+        }
+        if (vruntimeBefore(schedulingInfo[pid].vruntime, minVruntime)) {
+            schedulingInfo[pid].vruntime = minVruntime;
+        }
+        if (!next || vruntimeBefore(schedulingInfo[pid].vruntime, schedulingInfo[next].vruntime)) {
+            next = pid;
+        }
+    }
+
+    if (!next) {
+        return 0;
+    }
+
+    minVruntime = schedulingInfo[next].vruntime;
+    schedulingInfo[next].vruntime += VRUNTIME_SCALE / ((uint16_t)processes[next].priority + 1);
+
+    return next;
+}
+
+/*!
+ *  This function realizes the cyclic-executive strategy. The schedule was fixed at build time
+ *  (see REGISTER_CYCLIC_SCHEDULE), so every timer tick simply starts the next minor frame and
+ *  wraps around at the end of the major frame. This takes the same time in every call and makes
+ *  the timing of the schedule fully deterministic. Calls between the ticks (a process yields,
+ *  blocks or terminates) stay in the running frame, so they cannot shift the schedule. If the
+ *  process of a frame is not runnable, the frame is left to the idle process instead of being
+ *  given to another process.
+ *
+ *  \param processes An array holding the processes to choose the next process from.
+ *  \param current The id of the current process.
+ *  \return The next process to be executed, determined based on the cyclic-executive strategy.
+ */
+ProcessID os_Scheduler_CyclicExecutive(Process const processes[], ProcessID current) {
+    if (os_isSchedulerTick()) {
+        cyclicOwner = pgm_read_byte(&os_cyclicSchedule.slots[cyclicFrame]);
+        if (++cyclicFrame >= pgm_read_byte(&os_cyclicSchedule.length)) {
+            cyclicFrame = 0;
+        }
+    }
+
+    return os_isRunnable(&processes[cyclicOwner]) ? cyclicOwner : 0;
 }
@@ -11,11 +11,116 @@
 #ifndef _OS_SCHEDULING_STRATEGIES_H
 #define _OS_SCHEDULING_STRATEGIES_H
 
+#include <avr/pgmspace.h>
+
 #include "defines.h"
 #include "os_scheduler.h"
 
-//! Structure used to store specific scheduling informations such as a time slice
-// This is a presence task
+/*!
+ *  Structure used to store specific scheduling informations such as a time slice.
+ *  Only the member of the active strategy is valid, since the information of all
+ *  processes is reset whenever the strategy changes. This keeps the table at four
+ *  bytes per process.
+ */
+typedef union SchedulingInformation {
+    //! Remaining scheduler calls of the current time slice (round-robin strategy)
+    uint8_t timeSlice;
+
+    //! Priority accumulated while waiting (inactive-aging strategy)
+    Age age;
+
+    //! Virtual time of the process within its group (fair-share strategy)
+    uint16_t pass;
+
+    //! Queue position (MLFQ strategy)
+    struct {
+        //! The queue the process is in, 0 being the most favourable
+        uint8_t level;
+
+        //! Remaining scheduler calls of the current quantum
+        uint8_t slice;
+
+        //! When the process was appended to its queue
+        uint8_t enqueued;
+    } mlfq;
+
+    //! Processor time received, weighted by the priority (completely-fair strategy)
+    uint32_t vruntime;
+} SchedulingInformation;
+
+/*!
+ *  The static schedule of the cyclic-executive strategy. Each scheduler call
+ *  is one minor frame, and slots[i] is the process that runs in minor frame i
+ *  of the major frame. The schedule resides in flash and is generated at
+ *  build time by REGISTER_CYCLIC_SCHEDULE.
+ */
+typedef struct CyclicSchedule {
+    //! Number of minor frames in the major frame
+    uint8_t length;
+
+    //! The process to run in each minor frame (0 leaves the frame to idle)
+    ProcessID slots[CYCLIC_MAX_FRAMES];
+} CyclicSchedule;
+
+//! The cyclic schedule (an idle-only default is used if none is registered)
+extern CyclicSchedule const os_cyclicSchedule PROGMEM;
+
+//! Used by REGISTER_CYCLIC_SCHEDULE to check that a task names a valid process
+#define CYCLIC_TASK_VALID(FRAME, PID, MASK)  && ((PID) > 0) && ((PID) < MAX_NUMBER_OF_PROCESSES)
+
+//! Used by REGISTER_CYCLIC_SCHEDULE to collect the frames used by all tasks
+#define CYCLIC_TASK_OR(FRAME, PID, MASK)     | (uint32_t)(MASK)
+
+//! Used by REGISTER_CYCLIC_SCHEDULE to detect tasks that share a frame
+#define CYCLIC_TASK_SUM(FRAME, PID, MASK)    + (uint64_t)(uint32_t)(MASK)
+
+//! Used by REGISTER_CYCLIC_SCHEDULE to determine which task runs in a frame
+#define CYCLIC_TASK_SLOT(FRAME, PID, MASK)   + ((((uint32_t)(MASK) >> (FRAME)) & 1) ? (PID) : 0)
+
+//! The process that runs in a minor frame of a task set
+#define CYCLIC_SLOT(TASKSET, FRAME) (0 TASKSET(CYCLIC_TASK_SLOT, FRAME))
+
+/*!
+ *  Generates the schedule of the cyclic-executive strategy from a declarative
+ *  task set and checks its feasibility at compile time. The task set is a
+ *  macro that applies its first argument to every task as
+ *  TASK(ARG, pid, frames), where frames is a bit set of the minor frames the
+ *  process runs in. The build fails if a task names an invalid process, uses
+ *  a frame beyond the major frame or shares a frame with another task.
+ *  Use this macro in this fashion:
+ *
+ *    #define CONTROL_TASKS(TASK, ARG) \
+ *        TASK(ARG, 1, 0b01010101)     \
+ *        TASK(ARG, 2, 0b00100010)     \
+ *        TASK(ARG, 3, 0b10000000)
+ *    REGISTER_CYCLIC_SCHEDULE(CONTROL_TASKS, 8);
+ *
+ *  Process 1 runs in every other frame, process 2 in frames 1 and 5, process
+ *  3 in frame 7, and frame 3 is left to the idle process.
+ */
+#define REGISTER_CYCLIC_SCHEDULE(TASKSET, FRAMES)                                                      \
+    _Static_assert((FRAMES) > 0 && (FRAMES) <= CYCLIC_MAX_FRAMES, "Invalid number of minor frames");   \
+    _Static_assert(1 TASKSET(CYCLIC_TASK_VALID, 0), "Cyclic task names an invalid process");           \
+    _Static_assert(((0ul TASKSET(CYCLIC_TASK_OR, 0)) & ~((2ul << ((FRAMES) - 1)) - 1)) == 0,           \
+                   "Cyclic task runs beyond the major frame");                                         \
+    _Static_assert((0ull TASKSET(CYCLIC_TASK_SUM, 0)) == (0ul TASKSET(CYCLIC_TASK_OR, 0)),             \
+                   "Cyclic tasks share a minor frame");                                                \
+    CyclicSchedule const os_cyclicSchedule PROGMEM = {                                                 \
+        .length = (FRAMES),                                                                            \
+        .slots = {                                                                                     \
+            CYCLIC_SLOT(TASKSET, 0),  CYCLIC_SLOT(TASKSET, 1),  CYCLIC_SLOT(TASKSET, 2),               \
+            CYCLIC_SLOT(TASKSET, 3),  CYCLIC_SLOT(TASKSET, 4),  CYCLIC_SLOT(TASKSET, 5),               \
+            CYCLIC_SLOT(TASKSET, 6),  CYCLIC_SLOT(TASKSET, 7),  CYCLIC_SLOT(TASKSET, 8),               \
+            CYCLIC_SLOT(TASKSET, 9),  CYCLIC_SLOT(TASKSET, 10), CYCLIC_SLOT(TASKSET, 11),              \
+            CYCLIC_SLOT(TASKSET, 12), CYCLIC_SLOT(TASKSET, 13), CYCLIC_SLOT(TASKSET, 14),              \
+            CYCLIC_SLOT(TASKSET, 15), CYCLIC_SLOT(TASKSET, 16), CYCLIC_SLOT(TASKSET, 17),              \
+            CYCLIC_SLOT(TASKSET, 18), CYCLIC_SLOT(TASKSET, 19), CYCLIC_SLOT(TASKSET, 20),              \
+            CYCLIC_SLOT(TASKSET, 21), CYCLIC_SLOT(TASKSET, 22), CYCLIC_SLOT(TASKSET, 23),              \
+            CYCLIC_SLOT(TASKSET, 24), CYCLIC_SLOT(TASKSET, 25), CYCLIC_SLOT(TASKSET, 26),              \
+            CYCLIC_SLOT(TASKSET, 27), CYCLIC_SLOT(TASKSET, 28), CYCLIC_SLOT(TASKSET, 29),              \
+            CYCLIC_SLOT(TASKSET, 30), CYCLIC_SLOT(TASKSET, 31)                                         \
+        }                                                                                              \
+    }
 
 //! Used to reset the SchedulingInfo for one process
 void os_resetProcessSchedulingInformation(ProcessID id);
@@ -23,6 +128,9 @@ void os_resetProcessSchedulingInformation(ProcessID id);
 //! Used to reset the SchedulingInfo for a strategy
 void os_resetSchedulingInformation(SchedulingStrategy strategy);
 
+//! Tells whether the active strategy would run a process instead of the current one
+bool os_isPreferred(Process const processes[], ProcessID candidate, ProcessID current);
+
 //! Even strategy
 ProcessID os_Scheduler_Even(Process const processes[], ProcessID current);
 
@@ -38,5 +146,17 @@ ProcessID os_Scheduler_InactiveAging(Process const processes[], ProcessID curren
 //! RunToCompletion strategy
 ProcessID os_Scheduler_RunToCompletion(Process const processes[], ProcessID current);
 
+//! FairShare strategy
+ProcessID os_Scheduler_FairShare(Process const processes[], ProcessID current);
+
+//! MultiLevelFeedbackQueue strategy
+ProcessID os_Scheduler_MLFQ(Process const processes[], ProcessID current);
+
+//! CompletelyFair strategy
+ProcessID os_Scheduler_CompletelyFair(Process const processes[], ProcessID current);
+
+//! CyclicExecutive strategy
+ProcessID os_Scheduler_CyclicExecutive(Process const processes[], ProcessID current);
+
 ProcessID find_next_ready_process(Process const processes[], ProcessID current, int direction);
 #endif
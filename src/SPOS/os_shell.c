@@ -0,0 +1,506 @@
+/*! \file
+ *  \brief Command shell on USART0.
+ *
+ *  The shell reads a line, splits it into words and runs the command named
+ *  by the first word. It answers every command with plain text lines and
+ *  then prints the prompt "> " again, so a script only has to wait for the
+ *  prompt. The USART is locked from the end of a command line until the
+ *  next prompt was printed, so the answer cannot be torn apart by telemetry
+ *  frames; only while the shell waits for input other processes may write.
+ *  Commands that change the system ask os_askPermission like the
+ *  task manager does. The line and the words are kept in static memory, as
+ *  the stack of a process is small.
+ */
+
+#include "os_shell.h"
+
+#include <avr/pgmspace.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "os_format.h"
+#include "os_log.h"
+#include "os_scheduler.h"
+#include "os_stats.h"
+#include "os_telemetry.h"
+#include "os_trace.h"
+#include "os_usart.h"
+#include "os_user_privileges.h"
+
+//----------------------------------------------------------------------------
+// Private types
+//----------------------------------------------------------------------------
+
+//! A command of the shell
+typedef struct ShellCommand {
+    char name[7];
+    void (*run)(void);
+    char usage[14];
+} ShellCommand;
+
+//----------------------------------------------------------------------------
+// Private function declarations
+//----------------------------------------------------------------------------
+
+static void sh_help(void);
+static void sh_ps(void);
+static void sh_progs(void);
+static void sh_run(void);
+static void sh_kill(void);
+static void sh_nice(void);
+static void sh_sched(void);
+static void sh_trace(void);
+static void sh_log(void);
+static void sh_prof(void);
+static void sh_telem(void);
+
+//----------------------------------------------------------------------------
+// Private constants
+//----------------------------------------------------------------------------
+
+//! Maximum number of words of a command line (including the command)
+#define SHELL_MAX_WORDS 3
+
+//! The commands, looked up by name
+static ShellCommand const commands[] PROGMEM = {
+    {"help", sh_help, ""},
+    {"ps", sh_ps, ""},
+    {"progs", sh_progs, ""},
+    {"run", sh_run, "<name|id>"},
+    {"kill", sh_kill, "<pid>"},
+    {"nice", sh_nice, "<pid> <prio>"},
+    {"sched", sh_sched, "[<name|id>]"},
+    {"trace", sh_trace, ""},
+    {"log", sh_log, ""},
+    {"prof", sh_prof, ""},
+    {"telem", sh_telem, "[<ms>]"},
+};
+
+//! Number of commands
+#define SHELL_COMMANDS (sizeof(commands) / sizeof(commands[0]))
+
+//! The names of the scheduling strategies, in the order of SchedulingStrategy
+static char const strategyNames[][7] PROGMEM = {
+    [OS_SS_EVEN] = "even",
+    [OS_SS_RANDOM] = "random",
+    [OS_SS_RUN_TO_COMPLETION] = "rtc",
+    [OS_SS_ROUND_ROBIN] = "rr",
+    [OS_SS_INACTIVE_AGING] = "aging",
+    [OS_SS_FAIR_SHARE] = "fair",
+    [OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE] = "mlfq",
+    [OS_SS_COMPLETELY_FAIR] = "cfs",
+    [OS_SS_CYCLIC_EXECUTIVE] = "cyclic",
+};
+
+//! Number of scheduling strategies
+#define SHELL_STRATEGIES (sizeof(strategyNames) / sizeof(strategyNames[0]))
+
+//! A letter for every ProcessState
+static char const stateLetters[] PROGMEM = {
+    [OS_PS_UNUSED] = '-',
+    [OS_PS_READY] = 'R',
+    [OS_PS_RUNNING] = '*',
+    [OS_PS_BLOCKED] = 'B',
+};
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! The command line being read
+static char line[SHELL_LINE_LENGTH + 1];
+
+//! The words of the command line
+static char *words[SHELL_MAX_WORDS];
+
+//! Number of words of the command line
+static uint8_t wordCount;
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Reads a line into 'line', echoing it (without the final line break).
+ *  Backspace removes the last
+ *  character, characters beyond SHELL_LINE_LENGTH are ignored. A line ends
+ *  with CR or LF; an LF right after a CR does not end another line.
+ */
+static void sh_readLine(void) {
+    static bool afterCR;
+    uint8_t length = 0;
+
+    for (;;) {
+        char const c = os_usartGetChar();
+        if (c == '\n' && afterCR) {
+            afterCR = false;
+            continue;
+        }
+        afterCR = c == '\r';
+        if (c == '\r' || c == '\n') {
+            break;
+        }
+        if (c == '\b' || c == 0x7F) {
+            if (length) {
+                length--;
+                os_printProgString(usartio, PSTR("\b \b"));
+            }
+        } else if (c >= ' ' && length < SHELL_LINE_LENGTH) {
+            line[length++] = c;
+            os_usartPutChar(c);
+        }
+    }
+    line[length] = '\0';
+}
+
+/*!
+ *  Splits 'line' at spaces into 'words'. Words beyond SHELL_MAX_WORDS stay
+ *  part of the last word.
+ */
+static void sh_splitLine(void) {
+    wordCount = 0;
+    char *c = line;
+    while (wordCount < SHELL_MAX_WORDS) {
+        while (*c == ' ') {
+            c++;
+        }
+        if (!*c) {
+            break;
+        }
+        words[wordCount++] = c;
+        if (wordCount == SHELL_MAX_WORDS) {
+            break;
+        }
+        while (*c && *c != ' ') {
+            c++;
+        }
+        if (*c) {
+            *c++ = '\0';
+        }
+    }
+}
+
+/*!
+ *  Parses a decimal number.
+ *
+ *  \param word The text to parse.
+ *  \param number Receives the number.
+ *  \return False, iff the text is not a number below 65536.
+ */
+static bool sh_parseNumber(char const *word, uint16_t *number) {
+    uint32_t value = 0;
+    if (!*word) {
+        return false;
+    }
+    for (; *word; word++) {
+        if (*word < '0' || *word > '9') {
+            return false;
+        }
+        value = value * 10 + (*word - '0');
+        if (value > UINT16_MAX) {
+            return false;
+        }
+    }
+    *number = value;
+    return true;
+}
+
+/*!
+ *  Writes a flash string followed by a line break.
+ *
+ *  \param text The string (flash address of the first character).
+ */
+static void sh_println(char const *text) {
+    os_printProgString(usartio, text);
+    os_printProgString(usartio, PSTR("\r\n"));
+}
+
+/*!
+ *  Asks whether a command may be executed and tells the user if not.
+ *
+ *  \param pr The request of the command.
+ *  \param ra The argument of the request.
+ *  \param raf Which member of ra is set.
+ *  \return True, iff the command may be executed.
+ */
+static bool sh_allowed(PermissionRequest pr, RequestArgument ra, RequestArgumentFlag raf) {
+    char const *reason = NULL;
+    switch (os_askPermission(pr, ra, raf, &reason)) {
+        case OS_AP_ALLOW:
+            return true;
+        case OS_AP_EXPLICIT_DENY:
+            os_printProgString(usartio, PSTR("denied"));
+            if (reason) {
+                os_printf_P(usartio, PSTR(": %S"), reason);
+            }
+            sh_println(PSTR(""));
+            return false;
+        default:
+            sh_println(PSTR("?"));
+            return false;
+    }
+}
+
+/*!
+ *  Parses a process ID given as the second word.
+ *
+ *  \param pid Receives the process ID.
+ *  \return False, iff there is no valid process ID (the user was told).
+ */
+static bool sh_parsePid(ProcessID *pid) {
+    uint16_t number;
+    if (wordCount < 2 || !sh_parseNumber(words[1], &number) || number >= MAX_NUMBER_OF_PROCESSES) {
+        sh_println(PSTR("bad pid"));
+        return false;
+    }
+    *pid = number;
+    return true;
+}
+
+/*!
+ *  Writes the name of the program a process runs, or its address if it is
+ *  not registered.
+ *
+ *  \param program The function of the program.
+ */
+static void sh_printProgram(Program *program) {
+    ProgramID const id = os_findProgram(program);
+    if (id == INVALID_PROGRAM) {
+        os_printf_P(usartio, PSTR("@%04x"), (uint16_t)program);
+    } else {
+        os_printProgString(usartio, os_getProgramRegistry()[id].name);
+    }
+}
+
+/*!
+ *  help: lists the commands with their arguments.
+ */
+static void sh_help(void) {
+    for (uint8_t i = 0; i < SHELL_COMMANDS; i++) {
+        os_printf_P(usartio, PSTR("%S %S\r\n"), commands[i].name, commands[i].usage);
+    }
+}
+
+/*!
+ *  ps: lists the processes with their state, priority, share of the
+ *  processor, maximum stack usage and program.
+ */
+static void sh_ps(void) {
+    sh_println(PSTR("PID S PRIO CPU STACK PROG"));
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        Process const process = *os_getProcessSlot(pid);
+        if (process.state == OS_PS_UNUSED) {
+            continue;
+        }
+        os_printf_P(usartio, PSTR("%3u %c %4u %2u%% %3u/%u "),
+                    pid, pgm_read_byte(&stateLetters[process.state]), process.priority,
+                    os_getProcessCpuUtilization(pid), os_getStackWatermark(pid), STACK_SIZE_PROC);
+        sh_printProgram(process.program);
+        sh_println(PSTR(""));
+    }
+}
+
+/*!
+ *  progs: lists the registered programs with their defaults.
+ */
+static void sh_progs(void) {
+    sh_println(PSTR("ID PRIO STACK FLAGS NAME"));
+    for (ProgramID id = 0; id < os_getNumberOfRegisteredPrograms(); id++) {
+        ProgramInfo info;
+        os_getProgramInfo(id, &info);
+        os_printf_P(usartio, PSTR("%2u %4u %5u %c%c%c   %s\r\n"),
+                    id, info.priority, info.stackSize,
+                    info.flags & OS_PF_AUTOSTART ? 'a' : '-',
+                    info.flags & OS_PF_SINGLETON ? 's' : '-',
+                    info.flags & OS_PF_HIDDEN ? 'h' : '-',
+                    info.name);
+    }
+}
+
+/*!
+ *  run <name|id>: starts a registered program.
+ */
+static void sh_run(void) {
+    uint16_t number;
+    ProgramID id = INVALID_PROGRAM;
+    if (wordCount >= 2) {
+        id = sh_parseNumber(words[1], &number) ? (number < INVALID_PROGRAM ? number : INVALID_PROGRAM) : os_lookupProgram(words[1]);
+    }
+    Program *const program = os_getProgramSlot(id);
+    if (!program) {
+        sh_println(PSTR("no such program"));
+        return;
+    }
+    if (!sh_allowed(OS_PR_START_PROG, (RequestArgument){.prog = program}, OS_RAF_prog)) {
+        return;
+    }
+
+    ProcessID const pid = os_execProgram(id);
+    if (pid == INVALID_PROCESS) {
+        sh_println(PSTR("failed"));
+    } else {
+        os_printf_P(usartio, PSTR("pid %u\r\n"), pid);
+    }
+}
+
+/*!
+ *  kill <pid>: terminates a process.
+ */
+static void sh_kill(void) {
+    ProcessID pid;
+    if (!sh_parsePid(&pid) || !sh_allowed(OS_PR_KILL, (RequestArgument){.pid = pid}, OS_RAF_pid)) {
+        return;
+    }
+    sh_println(os_kill(pid) ? PSTR("killed") : PSTR("failed"));
+}
+
+/*!
+ *  nice <pid> <prio>: changes the priority of a process.
+ */
+static void sh_nice(void) {
+    ProcessID pid;
+    uint16_t priority;
+    if (!sh_parsePid(&pid)) {
+        return;
+    }
+    if (wordCount < 3 || !sh_parseNumber(words[2], &priority) || priority > UINT8_MAX) {
+        sh_println(PSTR("bad priority"));
+        return;
+    }
+    if (!sh_allowed(OS_PR_PRIORITY, (RequestArgument){.pid = pid}, OS_RAF_pid)) {
+        return;
+    }
+    sh_println(os_setProcessPriority(pid, priority) ? PSTR("ok") : PSTR("failed"));
+}
+
+/*!
+ *  sched [<name|id>]: lists the scheduling strategies, marking the active
+ *  one, or activates a strategy.
+ */
+static void sh_sched(void) {
+    if (wordCount < 2) {
+        for (uint8_t ss = 0; ss < SHELL_STRATEGIES; ss++) {
+            os_printf_P(usartio, PSTR("%c%u %S\r\n"), ss == os_getSchedulingStrategy() ? '*' : ' ', ss, strategyNames[ss]);
+        }
+        return;
+    }
+
+    uint16_t ss;
+    if (!sh_parseNumber(words[1], &ss)) {
+        for (ss = 0; ss < SHELL_STRATEGIES && strcmp_P(words[1], strategyNames[ss]); ss++) {
+        }
+    }
+    if (ss >= SHELL_STRATEGIES) {
+        sh_println(PSTR("no such strategy"));
+        return;
+    }
+    if (!sh_allowed(OS_PR_SCHEDULING, (RequestArgument){.ss = ss}, OS_RAF_ss)) {
+        return;
+    }
+    os_setSchedulingStrategy(ss);
+    sh_println(PSTR("ok"));
+}
+
+/*!
+ *  trace: writes and clears the recorded scheduling events (see
+ *  os_dumpTrace), terminated by a line with a single dot.
+ */
+static void sh_trace(void) {
+    os_dumpTrace(usartio);
+    sh_println(PSTR("."));
+}
+
+/*!
+ *  log: writes and clears the deferred log as frames (see os_flushLog) for
+ *  tools/spos_log.py, terminated by a line with the number of records that
+ *  were dropped. The frames cannot be torn apart, as the shell holds the
+ *  USART lock while it runs a command.
+ */
+static void sh_log(void) {
+    uint8_t const dropped = os_getDroppedLogRecords();
+    os_flushLog(usartio);
+    os_printf_P(usartio, PSTR("%u dropped\r\n"), dropped);
+}
+
+/*!
+ *  prof: shows the utilization, the load averages and the context switch
+ *  rate, and the state history of every process, newest sample last.
+ */
+static void sh_prof(void) {
+    os_printf_P(usartio, PSTR("cpu %u%% sw %u/s load"), os_getCpuUtilization(), os_getContextSwitchRate());
+    for (LoadAveragePeriod period = 0; period < OS_LA_COUNT; period++) {
+        LoadAverage const load = os_getLoadAverage(period);
+        os_printf_P(usartio, PSTR(" %u.%02u"), LOAD_INT(load), LOAD_FRAC(load));
+    }
+    os_printf_P(usartio, PSTR("\r\nrx lost %u log lost %u\r\n"), os_getUsartOverruns(), os_getDroppedLogRecords());
+
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        StateHistory const history = os_getStateHistory(pid);
+        if (!history) {
+            continue;
+        }
+        os_printf_P(usartio, PSTR("%3u %2u%% "), pid, os_getProcessCpuUtilization(pid));
+        for (uint8_t age = STATE_HISTORY_LENGTH; age--;) {
+            os_usartPutChar(pgm_read_byte(&stateLetters[STATE_HISTORY_AT(history, age)]));
+        }
+        sh_println(PSTR(""));
+    }
+}
+
+/*!
+ *  telem [<ms>]: shows or sets the period of the telemetry snapshots, 0
+ *  pausing them. Unless they are paused, the telemetry process is started
+ *  if it is registered but not running.
+ */
+static void sh_telem(void) {
+    uint16_t ms;
+    if (wordCount >= 2) {
+        if (!sh_parseNumber(words[1], &ms)) {
+            sh_println(PSTR("bad period"));
+            return;
+        }
+        os_setTelemetryPeriod(ms);
+    }
+    os_printf_P(usartio, PSTR("%u ms\r\n"), os_getTelemetryPeriod());
+
+    ProgramID const id = os_findProgram(os_telemetry);
+    if (!os_getTelemetryPeriod() || id == INVALID_PROGRAM || os_isProgramRunning(id)) {
+        return;
+    }
+    if (sh_allowed(OS_PR_START_PROG, (RequestArgument){.prog = os_telemetry}, OS_RAF_prog)) {
+        ProcessID const pid = os_execProgram(id);
+        os_printf_P(usartio, pid == INVALID_PROCESS ? PSTR("not started\r\n") : PSTR("started, pid %u\r\n"), pid);
+    }
+}
+
+/*!
+ *  The program of the shell: powers up the USART, greets and then runs one
+ *  command per line until it is killed.
+ */
+void os_shell(void) {
+    os_initUsart();
+    os_lockUsart();
+    sh_println(PSTR("\r\nSPOS shell, 'help' lists the commands"));
+
+    for (;;) {
+        os_printProgString(usartio, PSTR("> "));
+        os_unlockUsart();
+        sh_readLine();
+        os_lockUsart();
+        os_printProgString(usartio, PSTR("\r\n"));
+        sh_splitLine();
+        if (!wordCount) {
+            continue;
+        }
+
+        uint8_t i = 0;
+        while (i < SHELL_COMMANDS && strcmp_P(words[0], commands[i].name)) {
+            i++;
+        }
+        if (i == SHELL_COMMANDS) {
+            sh_println(PSTR("unknown command, try 'help'"));
+            continue;
+        }
+        ((void (*)(void))pgm_read_word(&commands[i].run))();
+    }
+}
@@ -0,0 +1,35 @@
+/*! \file
+ *  \brief Command shell on USART0.
+ *
+ *  Contains a line-oriented shell for process control and introspection,
+ *  meant for a terminal or a script on the other end of the serial port
+ *  (e.g. the pty simavr creates for the UART).
+ */
+
+#ifndef _OS_SHELL_H
+#define _OS_SHELL_H
+
+#include "defines.h"
+#include "os_programs.h"
+
+//----------------------------------------------------------------------------
+// Macros
+//----------------------------------------------------------------------------
+
+//! Priority of the shell. It is blocked while waiting for input, so a high priority only makes it responsive.
+#define SHELL_PRIORITY 100
+
+//! Maximum length of a command line
+#define SHELL_LINE_LENGTH 32
+
+//! Registry entry for the shell, to be listed in REGISTER_PROGRAMS
+#define SHELL_PROGRAM PROGRAM("shell", os_shell, SHELL_PRIORITY, STACK_SIZE_PROC, OS_PF_AUTOSTART | OS_PF_SINGLETON | OS_PF_HIDDEN | OS_PF_SYSTEM)
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! The program of the shell process
+void os_shell(void);
+
+#endif
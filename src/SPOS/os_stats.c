@@ -0,0 +1,398 @@
+/*! \file
+ *  \brief Runtime statistics of the OS.
+ *
+ *  The scheduler reports every switch, so the time the idle process ran (and
+ *  mostly slept) is accounted with the resolution of timer 0. The share of a
+ *  sample period the idle process did not get is the CPU utilization.
+ *  The load average is the number of runnable processes (not counting idle),
+ *  averaged over every scheduler call in a sample period and then smoothed
+ *  exponentially like the load average of Unix systems, only in seconds
+ *  instead of minutes.
+ *  The same accounting yields the share of every process, the number of
+ *  context switches and a short history of the process states. The stack of
+ *  a new process is painted, so the deepest stack usage can be found later.
+ *  Finally the longest critical section and the latency of the scheduler
+ *  interrupt are tracked, as both delay the reaction to events.
+ */
+
+#include "os_stats.h"
+
+#include <stdbool.h>
+#include <string.h>
+#include <util/atomic.h>
+
+#include "defines.h"
+#include "os_core.h"
+#include "os_process.h"
+#include "os_scheduler.h"
+#include "util.h"
+
+//----------------------------------------------------------------------------
+// Private constants
+//----------------------------------------------------------------------------
+
+//! Period in timer 0 counts (one second) after which utilization and load average are updated
+#define SAMPLE_PERIOD (F_CPU / TC0_PRESCALER)
+
+/*!
+ *  Decay factors of the load average for a SAMPLE_PERIOD of one second:
+ *  LOAD_FIXED_1 * exp(-1s / period)
+ */
+static uint16_t const loadDecay[OS_LA_COUNT] PROGMEM = {
+    [OS_LA_1S] = 753,
+    [OS_LA_5S] = 1677,
+    [OS_LA_15S] = 1916,
+};
+
+//! Value the unused part of a process stack is painted with
+#define STACK_PAINT 0xA5
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! Time (in timer 0 counts) every process ran in the current sample period
+static Time processTime[MAX_NUMBER_OF_PROCESSES];
+
+//! System time (in timer 0 counts) of the last process switch
+static Time lastSwitch;
+
+//! The process that runs since the last process switch
+static ProcessID running;
+
+//! Context switches in the current sample period
+static uint16_t switches;
+
+//! Context switches per second measured in the last sample period
+static uint16_t switchRate;
+
+//! CPU utilization of every process measured in the last sample period
+static uint8_t processUtilization[MAX_NUMBER_OF_PROCESSES];
+
+//! The states of every process in the last sample periods, 2 bits each, newest in the lowest bits
+static StateHistory stateHistory[MAX_NUMBER_OF_PROCESSES];
+
+//! System time (in timer 0 counts) at which the current sample period started
+static Time sampleStart;
+
+//! Sum of the runnable processes seen by the scheduler calls of the current sample period
+static uint32_t runnableSum;
+
+//! Scheduler calls in the current sample period
+static uint16_t sampleTicks;
+
+//! CPU utilization measured in the last sample period
+static uint8_t utilization;
+
+//! Exponentially smoothed number of runnable processes
+static LoadAverage loadAverage[OS_LA_COUNT];
+
+//! Time (in timer 0 counts) every process ran since it was started
+static Time processTotalTime[MAX_NUMBER_OF_PROCESSES];
+
+//! System time (in timer 0 counts) at which the outermost critical section was entered
+static Time criticalStart;
+
+//! Longest critical section (in timer 0 counts) since the last os_takeCriticalSectionStats
+static uint16_t criticalLongest;
+
+//! Deepest nesting of critical sections since the last os_takeCriticalSectionStats
+static uint8_t criticalDeepest;
+
+//! Shortest latency (in clock cycles) of the scheduler interrupt since the last os_takeTickLatency
+static uint16_t latencyMin = UINT16_MAX;
+
+//! Longest latency (in clock cycles) of the scheduler interrupt since the last os_takeTickLatency
+static uint16_t latencyMax;
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Resets the statistics. Called by os_init once the system time was reset.
+ */
+void os_initStats(void) {
+    sampleStart = os_systemTime_augment();
+    lastSwitch = sampleStart;
+    running = os_getCurrentProc();
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        processTime[pid] = 0;
+        processUtilization[pid] = 0;
+        stateHistory[pid] = 0;
+    }
+    switches = 0;
+    switchRate = 0;
+    runnableSum = 0;
+    sampleTicks = 0;
+    utilization = 0;
+    for (LoadAveragePeriod period = 0; period < OS_LA_COUNT; period++) {
+        loadAverage[period] = 0;
+    }
+}
+
+/*!
+ *  Accounts the time since the last switch to the process that ran, counts
+ *  the runnable processes and, once per sample period, computes the CPU
+ *  utilization and updates the load averages. Called by the scheduler
+ *  (with interrupts disabled) after it chose the next process.
+ */
+void os_statsTick(void) {
+    Time const now = os_systemTime_augment();
+    processTime[running] += now - lastSwitch;
+    processTotalTime[running] += now - lastSwitch;
+    lastSwitch = now;
+    if (running != os_getCurrentProc()) {
+        switches++;
+        running = os_getCurrentProc();
+    }
+
+    for (ProcessID pid = 1; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        if (os_isRunnable(os_getProcessSlot(pid))) {
+            runnableSum++;
+        }
+    }
+    sampleTicks++;
+
+    Time const elapsed = now - sampleStart;
+    if (elapsed < SAMPLE_PERIOD) {
+        return;
+    }
+
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        uint32_t const percent = processTime[pid] * 100 / elapsed;
+        processUtilization[pid] = percent > 100 ? 100 : percent;
+
+        // A process that ran at all counts as running for the whole period
+        ProcessState state = os_getProcessSlot(pid)->state;
+        if (processTime[pid]) {
+            state = OS_PS_RUNNING;
+        } else if (state == OS_PS_RUNNING) {
+            state = OS_PS_READY;
+        }
+        stateHistory[pid] = (stateHistory[pid] << 2) | state;
+        processTime[pid] = 0;
+    }
+    utilization = 100 - processUtilization[0];
+    switchRate = (uint32_t)switches * SAMPLE_PERIOD / elapsed;
+    switches = 0;
+
+    uint32_t const sample = (runnableSum << LOAD_FSHIFT) / sampleTicks;
+    for (LoadAveragePeriod period = 0; period < OS_LA_COUNT; period++) {
+        uint16_t const decay = pgm_read_word(&loadDecay[period]);
+        loadAverage[period] = ((uint32_t)loadAverage[period] * decay + sample * (LOAD_FIXED_1 - decay)) >> LOAD_FSHIFT;
+    }
+
+    runnableSum = 0;
+    sampleTicks = 0;
+    sampleStart = now;
+
+    os_governClock(utilization);
+}
+
+/*!
+ *  A simple getter for the CPU utilization.
+ *
+ *  \return The share of the processor not used by the idle process during the
+ *          last sample period in percent.
+ */
+uint8_t os_getCpuUtilization(void) {
+    return utilization;
+}
+
+/*!
+ *  A simple getter for the load average.
+ *
+ *  \param period The period to average over.
+ *  \return The average number of runnable processes as a fixed-point number
+ *          (see LOAD_INT and LOAD_FRAC).
+ */
+LoadAverage os_getLoadAverage(LoadAveragePeriod period) {
+    if (period >= OS_LA_COUNT) {
+        return 0;
+    }
+
+    LoadAverage load;
+    ATOMIC {
+        load = loadAverage[period];
+    }
+    return load;
+}
+
+/*!
+ *  A simple getter for the CPU utilization of a process.
+ *
+ *  \param pid The process to look at.
+ *  \return The share of the processor the process got during the last
+ *          sample period in percent.
+ */
+uint8_t os_getProcessCpuUtilization(ProcessID pid) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES) {
+        return 0;
+    }
+    return processUtilization[pid];
+}
+
+/*!
+ *  A simple getter for the context switch rate.
+ *
+ *  \return The number of switches between different processes per second,
+ *          measured in the last sample period.
+ */
+uint16_t os_getContextSwitchRate(void) {
+    uint16_t rate;
+    ATOMIC {
+        rate = switchRate;
+    }
+    return rate;
+}
+
+/*!
+ *  Returns the state history of a process. Every sample period adds the
+ *  state of the process as 2 bits (a ProcessState, where OS_PS_RUNNING means
+ *  the process ran at all), shifting the older ones up.
+ *
+ *  \param pid The process to look at.
+ *  \return The last STATE_HISTORY_LENGTH states, the newest in the lowest bits.
+ */
+StateHistory os_getStateHistory(ProcessID pid) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES) {
+        return 0;
+    }
+
+    StateHistory history;
+    ATOMIC {
+        history = stateHistory[pid];
+    }
+    return history;
+}
+
+/*!
+ *  The processor time a process got so far.
+ *
+ *  \param pid The process to look at.
+ *  \return The time the process ran since it was started in timer 0 counts.
+ */
+Time os_getProcessCpuTime(ProcessID pid) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES) {
+        return 0;
+    }
+
+    Time time;
+    ATOMIC {
+        time = processTotalTime[pid];
+    }
+    return time;
+}
+
+/*!
+ *  Paints the whole stack of a process and resets its processor time, called
+ *  by os_exec before it builds the initial stack frame.
+ *
+ *  \param pid The process whose stack is painted.
+ */
+void os_paintStack(ProcessID pid) {
+    uint8_t *const top = (uint8_t *)(PROCESS_STACK_BOTTOM(pid) - STACK_SIZE_PROC + 1);
+    memset(top, STACK_PAINT, STACK_SIZE_PROC);
+    processTotalTime[pid] = 0;
+}
+
+/*!
+ *  Determines how deep the stack of a process ever reached by looking for
+ *  the first byte (from the top) that is not painted anymore.
+ *
+ *  \param pid The process to look at.
+ *  \return The maximum number of stack bytes used by the process so far.
+ */
+uint16_t os_getStackWatermark(ProcessID pid) {
+    if (pid >= MAX_NUMBER_OF_PROCESSES || os_getProcessSlot(pid)->state == OS_PS_UNUSED) {
+        return 0;
+    }
+
+    uint8_t const *byte = (uint8_t const *)(PROCESS_STACK_BOTTOM(pid) - STACK_SIZE_PROC + 1);
+    uint16_t untouched = 0;
+    while (untouched < STACK_SIZE_PROC && *byte++ == STACK_PAINT) {
+        untouched++;
+    }
+    return STACK_SIZE_PROC - untouched;
+}
+
+/*!
+ *  Notes that a critical section was entered. Called by
+ *  os_enterCriticalSection with interrupts disabled.
+ *
+ *  \param depth The nesting depth including the new section.
+ */
+void os_statsCriticalSectionEntered(uint8_t depth) {
+    if (depth == 1) {
+        criticalStart = os_systemTime_augment();
+    }
+    if (depth > criticalDeepest) {
+        criticalDeepest = depth;
+    }
+}
+
+/*!
+ *  Notes that the outermost critical section was left. Called by
+ *  os_leaveCriticalSection with interrupts disabled.
+ */
+void os_statsCriticalSectionLeft(void) {
+    Time const duration = os_systemTime_augment() - criticalStart;
+    if (duration > criticalLongest) {
+        criticalLongest = duration > UINT16_MAX ? UINT16_MAX : duration;
+    }
+}
+
+/*!
+ *  Returns the maxima of the critical sections since the last call and
+ *  starts over. The duration has the resolution of timer 0 (TC0_PRESCALER
+ *  clock cycles), so short sections count as 0.
+ *
+ *  \param longest Receives the longest time the scheduler was disabled in timer 0 counts.
+ *  \param deepest Receives the deepest nesting of critical sections.
+ */
+void os_takeCriticalSectionStats(uint16_t *longest, uint8_t *deepest) {
+    ATOMIC {
+        *longest = criticalLongest;
+        *deepest = criticalDeepest;
+        criticalLongest = 0;
+        criticalDeepest = 0;
+    }
+}
+
+/*!
+ *  Notes the latency of a scheduler interrupt. Called by the scheduler when
+ *  it was entered by its timer.
+ *
+ *  \param counts The counts of timer 2 since the compare match.
+ */
+void os_statsTickLatency(uint8_t counts) {
+    uint32_t cycles = ((uint32_t)counts * os_getTickPrescaler()) << os_getClockDivision();
+    if (cycles > UINT16_MAX) {
+        cycles = UINT16_MAX;
+    }
+    if (cycles < latencyMin) {
+        latencyMin = cycles;
+    }
+    if (cycles > latencyMax) {
+        latencyMax = cycles;
+    }
+}
+
+/*!
+ *  Returns the range of the scheduler interrupt latency since the last call
+ *  and starts over. The difference of both is the jitter of the tick. The
+ *  latency is measured after the context was saved, so it includes a
+ *  constant offset, and it has the resolution of the timer 2 prescaler.
+ *
+ *  \param min Receives the shortest latency in clock cycles (UINT16_MAX if there was no tick).
+ *  \param max Receives the longest latency in clock cycles.
+ */
+void os_takeTickLatency(uint16_t *min, uint16_t *max) {
+    ATOMIC {
+        *min = latencyMin;
+        *max = latencyMax;
+        latencyMin = UINT16_MAX;
+        latencyMax = 0;
+    }
+}
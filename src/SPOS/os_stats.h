@@ -0,0 +1,104 @@
+/*! \file
+ *  \brief Runtime statistics of the OS.
+ *
+ *  Contains the measurement of the CPU utilization and the load average.
+ */
+
+#ifndef _OS_STATS_H
+#define _OS_STATS_H
+
+#include <stdint.h>
+
+#include "os_process.h"
+#include "util.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! Fixed-point number with LOAD_FSHIFT fractional bits
+typedef uint16_t LoadAverage;
+
+//! The periods the load average is available for
+typedef enum LoadAveragePeriod {
+    OS_LA_1S,
+    OS_LA_5S,
+    OS_LA_15S,
+    OS_LA_COUNT
+} LoadAveragePeriod;
+
+//! The states of a process in the last sample periods, see os_getStateHistory
+typedef uint32_t StateHistory;
+
+//----------------------------------------------------------------------------
+// Macros
+//----------------------------------------------------------------------------
+
+//! Number of fractional bits of a LoadAverage
+#define LOAD_FSHIFT 11
+
+//! The LoadAverage representing 1.0
+#define LOAD_FIXED_1 (1 << LOAD_FSHIFT)
+
+//! Number of sample periods a StateHistory covers
+#define STATE_HISTORY_LENGTH (sizeof(StateHistory) * 4)
+
+//! The state of a process the given number of sample periods ago
+#define STATE_HISTORY_AT(HISTORY, AGE) ((ProcessState)(((HISTORY) >> (2 * (AGE))) & 0x3))
+
+//! Integral part of a LoadAverage
+#define LOAD_INT(X) ((X) >> LOAD_FSHIFT)
+
+//! Fractional part of a LoadAverage in hundredths
+#define LOAD_FRAC(X) ((((X) & (LOAD_FIXED_1 - 1)) * 100) >> LOAD_FSHIFT)
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Resets the statistics
+void os_initStats(void);
+
+//! Collects the statistics, to be called by the scheduler on every switch
+void os_statsTick(void);
+
+//! The CPU utilization of the last sample period in percent
+uint8_t os_getCpuUtilization(void);
+
+//! The average number of runnable processes over the given period
+LoadAverage os_getLoadAverage(LoadAveragePeriod period);
+
+//! The share of the processor a process got in the last sample period in percent
+uint8_t os_getProcessCpuUtilization(ProcessID pid);
+
+//! Context switches per second in the last sample period
+uint16_t os_getContextSwitchRate(void);
+
+//! The states of a process in the last sample periods
+StateHistory os_getStateHistory(ProcessID pid);
+
+//! Paints the stack of a new process to measure its usage
+void os_paintStack(ProcessID pid);
+
+//! The maximum number of stack bytes a process used so far
+uint16_t os_getStackWatermark(ProcessID pid);
+
+//! The processor time a process got since it was started
+Time os_getProcessCpuTime(ProcessID pid);
+
+//! Notes that a critical section was entered, to be called by os_enterCriticalSection
+void os_statsCriticalSectionEntered(uint8_t depth);
+
+//! Notes that the outermost critical section was left, to be called by os_leaveCriticalSection
+void os_statsCriticalSectionLeft(void);
+
+//! The longest and the deepest critical section since the last call
+void os_takeCriticalSectionStats(uint16_t *longest, uint8_t *deepest);
+
+//! Notes the latency of a scheduler interrupt, to be called by the scheduler
+void os_statsTickLatency(uint8_t counts);
+
+//! The range of the scheduler interrupt latency since the last call
+void os_takeTickLatency(uint16_t *min, uint16_t *max);
+
+#endif
@@ -11,12 +11,17 @@ How does it work?
   Usually the dynamic graph of pages degenerates to a static tree, rooted at the "root-page".
 
 Control flow;
+  Pressing ENTER and ESC makes the scheduler start the TM as a process of its own (see `os_openTaskMan`),
+  which shows its own virtual console and terminates once the TM is left. While waiting for the user, the
+  TM is blocked and costs no processor time; pages showing live data are redrawn at a capped rate.
   When the TM is invoked, by calling `os_taskManMain`, it will automatically push the root-page to its
   display-buffer. The user may then select pages which are pushed on top of this root-page.
   When the buffer is empty, the TM terminates and returns control to its caller.
   All the work is done in `os_taskManMain` while the pages are specified as functions that can peek on the
   call stack to determine their respective context.
   Pages **NEVER** block (i.e. no busy waiting). All user interaction is done in `os_taskManMain`.
+  Pages are drawn into a frame of the LCD console (see `lcd_beginFrame`), so only the characters that
+  changed since the last drawing are sent to the LCD.
   If you wish to understands the details, there is no way around understanding how `os_taskManMain` works.
 
 Page specification;
@@ -34,8 +39,10 @@ Page specification;
 /* INTERFACE TO SPOS *****************************/
 
 #include "os_process.h"
+#include "os_programs.h"
 #include "os_scheduler.h"
 #include "os_input.h"
+#include "os_stats.h"
 #include "os_user_privileges.h"
 #if (VERSUCH >= 3)
     #include "os_memory.h"
@@ -45,7 +52,6 @@ Page specification;
 #pragma GCC optimize ("O3")
 
 Process* os_getProcessSlot(ProcessID);
-Program* os_getProgramSlot(Program);
 
 /* END OF INTERFACE DECLS ************************/
 
@@ -101,14 +107,16 @@ Program* os_getProgramSlot(Program);
 #define TM_MAP_ENTRIES_PER_PAGE 20
 
 /*!
- *  This is a wrapper for the os_getInput function of the os_input module.
- *  It is never used directly but utilizes a macro to use a stack variable as inputBuffer.
- *  \param inputBuffer The byte where to store the state of the buttons.
- *  \returns The content of the buffer.
+ *  Priority of the TM process. It is high, so the TM reacts quickly, which is
+ *  fine as it is blocked most of the time.
  */
-static uint8_t updateInputP(uint8_t* inputBuffer) {
-    return (*inputBuffer = os_getInput());
-}
+#define TM_PROCESS_PRIORITY 200
+
+/*!
+ *  Time in ms after which pages showing live data (see tm_markLive) are
+ *  redrawn if the user does not press a button.
+ */
+#define TM_REFRESH_PERIOD 250
 
 //! Index of the Escape-Button.
 #define ES 3
@@ -140,6 +148,13 @@ static char PROGMEM const failStr[] = "fail";
         lcd_writeProgString(failStr); \
     }
 
+/*!
+ *  Pages that show data which changes by itself (e.g. statistics) call this,
+ *  so they are redrawn every TM_REFRESH_PERIOD while they are shown. Pages
+ *  that execute commands must not do so, as they would execute them again.
+ */
+#define tm_markLive() (tm_live = true)
+
 //! A very convenient constant to pad strings with spaces.
 static char PROGMEM const spaces16[] = "                ";
 
@@ -239,13 +254,85 @@ static tm_page tm_rootpage;
  */
 static bool tm_open;
 
+//! Set by pages that are to be redrawn periodically, see tm_markLive.
+static bool tm_live;
+
+//! The process running the TM or INVALID_PROCESS.
+static ProcessID tm_pid = INVALID_PROCESS;
+
 bool os_taskManOpen() {
     return tm_open;
 }
 
 /*!
- *  This is the main entry point for the TM, as invoked e.g. from the
- *  scheduler.
+ *  The program of the TM process: shows the TM on its own console and
+ *  terminates when the TM is left, restoring the console shown before.
+ */
+static void tm_program(void) {
+    uint8_t const background = lcd_getForegroundConsole();
+    lcd_openConsole();
+    lcd_showConsole(os_getCurrentProc());
+
+    os_taskManMain();
+
+    lcd_showConsole(background);
+    tm_pid = INVALID_PROCESS;
+    os_exit();
+}
+
+/*!
+ *  Forgets the TM process if it was killed, so the TM counts as closed and
+ *  the next chord starts a new one. Called with the scheduler disabled.
+ *
+ *  \param pid The terminated process.
+ */
+void os_releaseProcessTaskMan(ProcessID pid) {
+    if (pid == tm_pid) {
+        tm_pid = INVALID_PROCESS;
+        tm_open = false;
+        tm_live = false;
+    }
+}
+
+/*!
+ *  Starts the TM process in SYSTEM_GROUP unless it is running already.
+ *  Called by the scheduler when ENTER and ESC are pressed.
+ */
+void os_openTaskMan(void) {
+    if (tm_pid == INVALID_PROCESS) {
+        tm_pid = os_exec(tm_program, TM_PROCESS_PRIORITY);
+        os_setProcessGroup(tm_pid, SYSTEM_GROUP);
+    }
+}
+
+/*!
+ *  Waits until all buttons are released, without using the processor.
+ */
+static void tm_waitForNoInput(void) {
+    while (os_getInput()) {
+        os_waitInputEvent(TM_REFRESH_PERIOD);
+    }
+    os_takeInputEvents();
+}
+
+/*!
+ *  Lets the current page draw itself into a frame, so that only the
+ *  characters that changed reach the LCD.
+ *  \param stack The stack of the TM, the top-most page is drawn.
+ *  \param pageResult Where the page writes its result to.
+ */
+static void tm_render(ParamStack const* stack, PageResult* pageResult) {
+    tm_live = false;
+    lcd_beginFrame();
+    lcd_clear();
+    stack->pages[stack->top].call(stack, pageResult);
+    lcd_endFrame();
+}
+
+/*!
+ *  This is the main entry point for the TM, as invoked by the TM process
+ *  (see os_openTaskMan). It must not be called from an ISR, as it blocks
+ *  while waiting for input.
  *  This function will dynamically build the call graph (!) of sub-pages
  *  during runtime and react on the user input, selecting the
  *  appropriate page.
@@ -288,19 +375,20 @@ void os_taskManMain(void) {
             }
 
             // Wait for confirmation (OK+ES)
-            while (os_getInput() != (1 | (1 << 3)));
-            os_waitForNoInput();
+            while (os_getInput() != (1 | (1 << 3))) {
+                os_waitInputEvent(0);
+            }
+            tm_waitForNoInput();
             return;
 
         default:
             break;
     }
 
+    // The chord that opened the TM is no input for its pages
+    tm_waitForNoInput();
     tm_open = true;
 
-    // Small shorthand to poll for user-input.
-    #define updateInput() updateInputP(&buttonInput)
-
     /*
      * Convenience macro to get the state of a specific button.
      * E.g. READ_BTN(DN) will check the buttonInput buffer and evaluate
@@ -308,8 +396,8 @@ void os_taskManMain(void) {
      */
     #define READ_BTN(BTN) ((buttonInput>>(BTN))&1)
 
-    // Here, only the low nibble is relevant.
-    uint8_t buttonInput;
+    // The buttons pressed since the last input, only the low nibble is relevant.
+    uint8_t buttonInput = 0;
 
     /*
      * This variable will later be used to store the information in which
@@ -358,14 +446,13 @@ void os_taskManMain(void) {
         do {
             stack.pages[stack.top].param += direction;
             stack.pages[stack.top].param %= stack.pages[stack.top].range;
-            lcd_clear();
 
             /*
              * The page is supposed to display nothing if it fails.
              * Observe, that return success=false does not mean that the page could
              * not execute a command by the user.
              */
-            stack.pages[stack.top].call(&stack, &pageResult);
+            tm_render(&stack, &pageResult);
 
             /*
              * If the user did not actually want to move (e.g. he just entered this
@@ -385,13 +472,17 @@ void os_taskManMain(void) {
             if (pageResult.success) {
                 /*
                  * Note how the user is not even bothered in case the current page failed.
-                 * After polling here, the poll-result that was read here, will be used
-                 * in the remainder of this iteration.
-                 * So even if the user manages to release a button faster than we can
-                 * process it, we will still know it was pressed (updateInput() has
-                 * heavy side effects, as it is a macro).
+                 * The TM process is blocked until a button is pressed, the scheduler
+                 * records every press, so none gets lost even if the button is released
+                 * before we get to run. Live pages are redrawn meanwhile, which stops
+                 * if they fail to display their index (e.g. a process terminated).
                  */
-                while (!updateInput());
+                while (!(buttonInput = os_waitInputEvent(tm_live ? TM_REFRESH_PERIOD : 0))) {
+                    tm_render(&stack, &pageResult);
+                    if (!pageResult.success) {
+                        break;
+                    }
+                }
             }
             newInput = true;
             if (READ_BTN(ES) || !pageResult.success) {
@@ -420,14 +511,12 @@ void os_taskManMain(void) {
                  */
                 newInput = false;
             }
-            while (updateInput());
         } while (!newInput);
         // This can occur if our design-time estimate of the stack size was too small.
         // { stack.top + 1 != 0 }
     }
     tm_open = false;
     lcd_clear();
-    #undef updateInput
     #undef READ_BTN
 }
 
@@ -439,6 +528,9 @@ char PROGMEM const mainLabels[] =
     "Change Priority                \0"
     "Change Scheduling Strategy     \0"
     "Heap(s)                        \0"
+    "Process Groups                 \0"
+    "Statistics                     \0"
+    "Start Program                  \0"
 ;
 
 // Forward declarations for the sub-pages of the root-page.
@@ -454,12 +546,16 @@ static tm_page tm_priority;
 
 #if TM_COMPILE_SCHEDULING_SUPPORT
 static tm_page tm_scheduling;
+static tm_page tm_groups;
 #endif
 
 #if TM_COMPILE_HEAP_SUPPORT
 static tm_page tm_heap;
 #endif
 
+static tm_page tm_stats;
+static tm_page tm_startProg;
+
 static tm_page tm_null;
 
 // A convenience macro to access the stack-history.
@@ -473,11 +569,7 @@ static tm_page tm_null;
 #define MAX6(Xa,X5...) (MAX2(Xa,(MAX5(X5))))
 
 #if TM_COMPILE_SCHEDULING_SUPPORT
-#if VERSUCH >= 5
-    #define SS_MAX_COUNT (MAX6(OS_SS_RUN_TO_COMPLETION, OS_SS_RANDOM, OS_SS_EVEN, OS_SS_ROUND_ROBIN, OS_SS_INACTIVE_AGING, OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE) + 1)
-#else
-    #define SS_MAX_COUNT (MAX5(OS_SS_RUN_TO_COMPLETION, OS_SS_RANDOM, OS_SS_EVEN, OS_SS_ROUND_ROBIN, OS_SS_INACTIVE_AGING) + 1)
-#endif
+    #define SS_MAX_COUNT (MAX4(MAX6(OS_SS_RUN_TO_COMPLETION, OS_SS_RANDOM, OS_SS_EVEN, OS_SS_ROUND_ROBIN, OS_SS_INACTIVE_AGING, OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE), OS_SS_FAIR_SHARE, OS_SS_COMPLETELY_FAIR, OS_SS_CYCLIC_EXECUTIVE) + 1)
 
 #endif
 
@@ -485,6 +577,13 @@ static tm_page tm_null;
 #define MS_MAX_COUNT (MAX4(OS_MEM_FIRST, OS_MEM_NEXT, OS_MEM_BEST, OS_MEM_WORST) + 1)
 #endif
 
+// The statistics pages: the system, every process and every heap
+#if TM_COMPILE_HEAP_SUPPORT
+    #define TM_STATS_PAGES (1 + MAX_NUMBER_OF_PROCESSES + TM_HEAP_SUPPORT)
+#else
+    #define TM_STATS_PAGES (1 + MAX_NUMBER_OF_PROCESSES)
+#endif
+
 /*!
  *  This is the root-page that shows the top-level pages of the TM.
  */
@@ -505,7 +604,7 @@ static TM_PAGE(tm_rootpage) {
         result->child.range = (uint16_t)(RANGE); \
         break; \
     }
-        SUBP(0, tm_frontpage, 0, 1)
+        SUBP(0, tm_frontpage, 0, 2)
 #if TM_COMPILE_KILL_SUPPORT
         SUBP(1, tm_killProc, os_getCurrentProc(), MAX_NUMBER_OF_PROCESSES)
 #endif
@@ -518,6 +617,11 @@ static TM_PAGE(tm_rootpage) {
 #if TM_COMPILE_HEAP_SUPPORT
         SUBP(4, tm_heap, 0, TM_HEAP_SUPPORT)
 #endif
+#if TM_COMPILE_SCHEDULING_SUPPORT
+        SUBP(5, tm_groups, 0, MAX_NUMBER_OF_GROUPS)
+#endif
+        SUBP(6, tm_stats, 0, TM_STATS_PAGES)
+        SUBP(7, tm_startProg, 0, MAX2(os_getNumberOfRegisteredPrograms(), 1))
 #undef SUBP
         default:
             result->child.call = tm_null;
@@ -626,10 +730,31 @@ static uint8_t getNumberOfActiveProcs(void) {
 
 /*!
  *  Front page. Tells you the running process and the number of slots
- *  occupied and the total number of slots.
+ *  occupied and the total number of slots. The second front page shows the
+ *  CPU utilization and the load average of the last 1, 5 and 15 seconds.
  *  Always returns true.
  */
 make_pagehandler(tm_frontpage, tm_null, 0, 0, OS_PR_FRONTPAGE, null, 0) {
+    tm_markLive();
+    if (peekStack(0).param) {
+        // Second front page: CPU utilization and load average of the last 1, 5 and 15 seconds
+        lcd_writeProgString(PSTR("CPU: "));
+        lcd_writeDec(os_getCpuUtilization());
+        lcd_writeChar('%');
+        lcd_line2();
+        for (LoadAveragePeriod period = 0; period < OS_LA_COUNT; period++) {
+            LoadAverage const load = os_getLoadAverage(period);
+            lcd_writeDec(LOAD_INT(load));
+            lcd_writeChar('.');
+            if (LOAD_FRAC(load) < 10) {
+                lcd_writeChar('0');
+            }
+            lcd_writeDec(LOAD_FRAC(load));
+            lcd_writeChar(' ');
+        }
+        return true;
+    }
+
     lcd_writeProgString(PSTR("Running: #"));
     lcd_writeDec(os_getCurrentProc());
     lcd_line2();
@@ -723,20 +848,18 @@ make_pagehandler(tm_killProc, tm_killProc_kill, 0, 1, OS_PR_KILL_SELECT, pid, pe
     return procMutator(p, PSTR("Kill"), ~uniqState(OS_PS_UNUSED));
 }
 
-extern ProcessID currentProc;
-bool internalKill(ProcessID pid){
-  ProcessID tmp = currentProc;
-  currentProc = INVALID_PROCESS;
-  bool result = os_kill(pid);
-  currentProc = tmp;
-  return result;
+/*!
+ *  Kills a process, except for the TM itself, which is left with ESC.
+ */
+static bool tm_kill(ProcessID pid) {
+    return pid != tm_pid && os_kill(pid);
 }
 
 /*!
  *  The page to kill a previously selected process.
  */
 make_pagehandler(tm_killProc_kill, tm_null, 0, 0, OS_PR_KILL, pid, peekStack(1).param) {
-    return procMutatorConfirm(p, PSTR("Killing"), PSTR("Cannot kill #0"), internalKill);
+    return procMutatorConfirm(p, PSTR("Killing"), PSTR("Cannot kill #0"), tm_kill);
 }
 
 #endif
@@ -825,9 +948,9 @@ make_pagehandler(tm_priority_changeL, tm_priority_set, 0, 1, OS_PR_PRIORITY, nul
  */
 make_pagehandler(tm_priority_set, tm_null, 0, 0, OS_PR_PRIORITY, pid, peekStack(4).param) {
     lcd_writeProgString(PSTR("Setting priority"));
-    os_getProcessSlot(peekStack(4).param)->priority
-        = ((peekStack(2).param & 0xF) << 4)
-          + ((peekStack(1).param & 0xF));
+    os_setProcessPriority(peekStack(4).param,
+                          ((peekStack(2).param & 0xF) << 4)
+                          + ((peekStack(1).param & 0xF)));
     tm_done();
     lcd_writeProgString(PSTR(", now: "));
     lcd_writeHexByte(os_getProcessSlot(peekStack(4).param)->priority);
@@ -955,9 +1078,10 @@ makeStrategyNameLookup(getSchedulingStratNames, 0x18, 0,
     {OS_SS_EVEN,                      PSTR("<Even>                 ")},
     {OS_SS_ROUND_ROBIN,               PSTR("<Round Robin>          ")},
     {OS_SS_INACTIVE_AGING,            PSTR("<Inactive Aging>       ")},
-    #if VERSUCH >= 5
+    {OS_SS_FAIR_SHARE,                PSTR("<Fair Share>           ")},
     {OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE, PSTR("<MLFQ>                 ")},
-    #endif
+    {OS_SS_COMPLETELY_FAIR,           PSTR("<Completely Fair>      ")},
+    {OS_SS_CYCLIC_EXECUTIVE,          PSTR("<Cyclic Executive>     ")},
 )
 
 /*!
@@ -979,6 +1103,34 @@ make_pagehandler(tm_scheduling_set, tm_null, 0, 0, OS_PR_SCHEDULING, ss, peekSta
                            setSS, 0);
 }
 
+/*!
+ *  The page to show a process group. It displays how many processes belong
+ *  to the group, the shares of the group and how much processor time the
+ *  group received recently.
+ */
+make_pagehandler(tm_groups, tm_null, 0, 0, OS_PR_SHOW_GROUPS, null, 0) {
+    tm_markLive();
+    ProcessGroup const group = peekStack(0).param;
+    uint8_t members = 0;
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        if (os_getProcessSlot(pid)->state != OS_PS_UNUSED && os_getProcessSlot(pid)->group == group) {
+            members++;
+        }
+    }
+    lcd_writeProgString(PSTR("Group "));
+    lcd_writeDec(group);
+    lcd_writeProgString(PSTR(": "));
+    lcd_writeDec(members);
+    lcd_writeProgString(PSTR(" procs"));
+    lcd_line2();
+    lcd_writeProgString(PSTR("Shr "));
+    lcd_writeDec(os_getGroupShares(group));
+    lcd_writeProgString(PSTR(" Use "));
+    lcd_writeDec(os_getGroupUsage(group));
+    lcd_writeChar('%');
+    return true;
+}
+
 #endif
 
 #if TM_COMPILE_HEAP_SUPPORT
@@ -991,7 +1143,7 @@ static const char *getHeapName(uint8_t ram) {
 /*!
  *  The page to select which heap to inspect. Supports NULL-heaps.
  */
-make_pagehandler(tm_heap, tm_heap2, 0, 4, OS_PR_SHOW_HEAP, heapId, peekStack(0).param) {
+make_pagehandler(tm_heap, tm_heap2, 0, 5, OS_PR_SHOW_HEAP, heapId, peekStack(0).param) {
     uint16_t const ram = peekStack(0).param;
     if (ram >= os_getHeapListLength() || !os_lookupHeap(ram)) {
         return false;
@@ -1007,6 +1159,7 @@ static tm_page tm_heap_strategy;
 static tm_page tm_heap_contents;
 static tm_page tm_heap_chunks;
 static tm_page tm_heap_erase;
+static tm_page tm_heap_usage;
 
 /*!
  *  The page to select what to do with a previously selected heap.
@@ -1015,6 +1168,7 @@ static tm_page tm_heap_erase;
  *   - dump the map
  *   - browse chunks
  *   - erase everything
+ *   - show the usage of every process
  */
 make_pagehandler(tm_heap2, tm_heap_strategy, 0, MS_MAX_COUNT, OS_PR_ALWAYS_ALLOW, null, 0) {
     Heap* const heap = os_lookupHeap(peekStack(1).param);
@@ -1045,6 +1199,13 @@ make_pagehandler(tm_heap2, tm_heap_strategy, 0, MS_MAX_COUNT, OS_PR_ALWAYS_ALLOW
             result->range = 1;
             break;
         }
+        case 4: {
+            lcd_writeProgString(PSTR("Usage by process"));
+            result->call = tm_heap_usage;
+            result->param = 1;
+            result->range = MAX_NUMBER_OF_PROCESSES;
+            break;
+        }
         default:
             return false;
     }
@@ -1136,6 +1297,27 @@ make_pagehandler(tm_heap_chunks, tm_null, 0, 0, OS_PR_SHOW_HEAP, null, 0) {
     return true;
 }
 
+/*!
+ *  The page to display how many bytes a process allocated in the previously
+ *  selected heap. Unused processes and the idle process, which cannot
+ *  allocate, are skipped.
+ */
+make_pagehandler(tm_heap_usage, tm_null, 0, 0, OS_PR_SHOW_HEAP, null, 0) {
+    Heap* const heap = os_lookupHeap(peekStack(2).param);
+    ProcessID const pid = peekStack(0).param;
+    if (!pid || os_getProcessSlot(pid)->state == OS_PS_UNUSED) {
+        return false;
+    }
+    lcd_writeProgString(PSTR("Usage of #"));
+    lcd_writeDec(pid);
+    lcd_line2();
+    lcd_writeDec(os_getUsage(heap, pid));
+    lcd_writeChar('/');
+    lcd_writeDec(os_getUseSize(heap));
+    lcd_writeProgString(PSTR(" bytes"));
+    return true;
+}
+
 make_pagehandler(tm_heap_erase, tm_heap_erase2, 0, 1, OS_PR_ERASE_HEAP, heapId, peekStack(2).param) {
     lcd_writeProgString(PSTR("Erase map+dat of"));
     lcd_writeString(getHeapName(peekStack(2).param));
@@ -1170,4 +1352,124 @@ make_pagehandler(tm_heap_erase2, tm_null, 0, 0, OS_PR_ERASE_HEAP, heapId, peekSt
 
 #endif
 
+/*!
+ *  Writes the state history of a process, oldest first: a full block for
+ *  every sample period the process ran, '-' if it was ready, '_' if it was
+ *  blocked and nothing while the slot was unused.
+ */
+static void tm_writeStateHistory(StateHistory history) {
+    for (uint8_t age = STATE_HISTORY_LENGTH; age--;) {
+        switch (STATE_HISTORY_AT(history, age)) {
+            case OS_PS_RUNNING:
+                lcd_writeCodeProgString(PSTR(LCD_STR_BAR));
+                break;
+            case OS_PS_READY:
+                lcd_writeChar('-');
+                break;
+            case OS_PS_BLOCKED:
+                lcd_writeChar('_');
+                break;
+            default:
+                lcd_writeChar(' ');
+                break;
+        }
+    }
+}
+
+/*!
+ *  The statistics pages, redrawn live. The first one shows the CPU
+ *  utilization as a bar and the context switches per second. Then there is
+ *  one page per process with its share of the processor, its maximum stack
+ *  usage and its state history, followed by one page per heap with its usage.
+ */
+make_pagehandler(tm_stats, tm_null, 0, 0, OS_PR_SHOW_STATS, null, 0) {
+    tm_markLive();
+    uint16_t index = peekStack(0).param;
+    if (!index) {
+        lcd_writeProgString(PSTR("CPU "));
+        lcd_writeDec(os_getCpuUtilization());
+        lcd_writeProgString(PSTR("% Sw "));
+        lcd_writeDec(os_getContextSwitchRate());
+        lcd_writeProgString(PSTR("/s"));
+        lcd_line2();
+        lcd_writeBar(os_getCpuUtilization(), 16);
+        return true;
+    }
+
+    index--;
+    if (index < MAX_NUMBER_OF_PROCESSES) {
+        ProcessID const pid = index;
+        if (os_getProcessSlot(pid)->state == OS_PS_UNUSED) {
+            return false;
+        }
+        lcd_writeChar('#');
+        lcd_writeDec(pid);
+        lcd_writeChar(' ');
+        lcd_writeDec(os_getProcessCpuUtilization(pid));
+        lcd_writeProgString(PSTR("% S"));
+        lcd_writeDec(os_getStackWatermark(pid));
+        lcd_writeChar('/');
+        lcd_writeDec(STACK_SIZE_PROC);
+        lcd_line2();
+        tm_writeStateHistory(os_getStateHistory(pid));
+        return true;
+    }
+
+#if TM_COMPILE_HEAP_SUPPORT
+    index -= MAX_NUMBER_OF_PROCESSES;
+    if (index >= os_getHeapListLength() || !os_lookupHeap(index)) {
+        return false;
+    }
+    Heap* const heap = os_lookupHeap(index);
+    uint16_t const used = os_getHeapUsage(heap);
+    uint16_t const size = os_getUseSize(heap);
+    lcd_writeString(getHeapName(index));
+    lcd_writeChar(' ');
+    lcd_writeDec(used);
+    lcd_writeChar('/');
+    lcd_writeDec(size);
+    lcd_line2();
+    lcd_writeBar(size ? (uint32_t)used * 100 / size : 0, 16);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*!
+ *  The page to select a registered program to start. It shows the name of
+ *  the program and the priority and stack it is started with. Hidden
+ *  programs are skipped.
+ */
+make_pagehandler(tm_startProg, tm_startProg_exec, 0, 1, OS_PR_START_PROG_SELECT, prog, os_getProgramSlot(peekStack(0).param)) {
+    ProgramInfo info;
+    if (!os_getProgramInfo(peekStack(0).param, &info) || (info.flags & OS_PF_HIDDEN)) {
+        return false;
+    }
+    lcd_writeProgString(PSTR("Start "));
+    lcd_writeString(info.name);
+    lcd_line2();
+    lcd_writeProgString(PSTR("Prty "));
+    lcd_writeDec(info.priority);
+    lcd_writeProgString(PSTR(" S"));
+    lcd_writeDec(info.stackSize);
+    return true;
+}
+
+/*!
+ *  The page to start a previously selected program.
+ */
+make_pagehandler(tm_startProg_exec, tm_null, 0, 0, OS_PR_START_PROG, prog, os_getProgramSlot(peekStack(1).param)) {
+    ProcessID const pid = os_execProgram(peekStack(1).param);
+    lcd_writeProgString(PSTR("Starting"));
+    if (pid != INVALID_PROCESS) {
+        lcd_writeProgString(PSTR(" as #"));
+        lcd_writeDec(pid);
+        tm_done();
+    } else {
+        tm_fail();
+    }
+    return true;
+}
+
 #pragma GCC pop_options
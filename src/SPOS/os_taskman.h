@@ -13,6 +13,8 @@
 
 #include <stdbool.h>
 
+#include "os_process.h"
+
 //----------------------------------------------------------------------------
 // Function headers
 //----------------------------------------------------------------------------
@@ -23,4 +25,10 @@ void os_taskManMain(void);
 //! Returns true if the TaskManager is currently open
 bool os_taskManOpen(void);
 
+//! Starts the TaskManager process unless it is running
+void os_openTaskMan(void);
+
+//! Forgets the TM process if it was killed
+void os_releaseProcessTaskMan(ProcessID pid);
+
 #endif
@@ -0,0 +1,206 @@
+/*! \file
+ *  \brief Binary telemetry over USART0.
+ *
+ *  A frame is
+ *
+ *      TELEMETRY_SYNC1 TELEMETRY_SYNC2 <length> <payload> <crc>
+ *
+ *  where length counts the payload bytes and crc is the CRC-16 of
+ *  _crc_ccitt_update (polynomial 0x8408 reflected, initial value 0xFFFF) over
+ *  the length and the payload, low byte first. A frame is sent with the
+ *  USART locked, so the output of other processes (e.g. the shell) only
+ *  appears between frames. That output is ASCII text, so a receiver that
+ *  sees TELEMETRY_SYNC1 knows that a frame starts. A receiver that loses
+ *  track searches for the next sync bytes and drops every frame whose CRC
+ *  does not match, e.g. because bytes were lost.
+ *
+ *  The payload (all numbers little endian) is
+ *
+ *      u8  TELEMETRY_VERSION
+ *      u32 system time in ms
+ *      u8  CPU utilization in percent
+ *      u16 context switches per second
+ *      u16 load average of the last second (LoadAverage)
+ *      u16 longest critical section since the last snapshot in timer 0 counts
+ *      u8  deepest nesting of critical sections since the last snapshot
+ *      u16 shortest scheduler interrupt latency since the last snapshot in cycles
+ *      u16 longest scheduler interrupt latency since the last snapshot in cycles
+ *      u8  number of heaps H, followed by H times
+ *          u16 free bytes of the heap
+ *      u8  number of processes P (MAX_NUMBER_OF_PROCESSES), followed by P times
+ *          u8  ProcessState
+ *          u32 processor time since the process was started in timer 0 counts
+ *          u16 stack watermark in bytes
+ */
+
+#include "os_telemetry.h"
+
+#include <util/crc16.h>
+
+#include "os_scheduler.h"
+#include "os_stats.h"
+#include "os_usart.h"
+#include "util.h"
+#if (VERSUCH >= 3)
+    #include "os_memory.h"
+#endif
+
+//----------------------------------------------------------------------------
+// Private constants
+//----------------------------------------------------------------------------
+
+//! Period in ms after which a paused telemetry checks whether it was resumed
+#define TELEMETRY_PAUSE_POLL 250
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! Period between two snapshots in ms, 0 while paused
+static uint16_t period = TELEMETRY_PERIOD;
+
+//! CRC of the frame being sent
+static uint16_t frameCrc;
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Sets the period between two snapshots. It takes effect after the next
+ *  snapshot.
+ *
+ *  \param ms The period in ms or 0 to pause the telemetry.
+ */
+void os_setTelemetryPeriod(uint16_t ms) {
+    period = ms;
+}
+
+/*!
+ *  A simple getter for the period between two snapshots.
+ *
+ *  \return The period in ms, 0 meaning paused.
+ */
+uint16_t os_getTelemetryPeriod(void) {
+    return period;
+}
+
+/*!
+ *  Sends a byte of the frame and adds it to the CRC.
+ *
+ *  \param byte The byte to send.
+ */
+static void tel_byte(uint8_t byte) {
+    frameCrc = _crc_ccitt_update(frameCrc, byte);
+    os_usartPutChar(byte);
+}
+
+/*!
+ *  Sends a 16 bit number of the frame, low byte first.
+ *
+ *  \param word The number to send.
+ */
+static void tel_word(uint16_t word) {
+    tel_byte(word);
+    tel_byte(word >> 8);
+}
+
+/*!
+ *  Sends a 32 bit number of the frame, low byte first.
+ *
+ *  \param dword The number to send.
+ */
+static void tel_dword(uint32_t dword) {
+    tel_word(dword);
+    tel_word(dword >> 16);
+}
+
+/*!
+ *  Number of heaps in a snapshot.
+ *
+ *  \return The number of heaps.
+ */
+static uint8_t tel_heapCount(void) {
+#if (VERSUCH >= 3)
+    return os_getHeapListLength();
+#else
+    return 0;
+#endif
+}
+
+/*!
+ *  Sends the heap part of a snapshot.
+ */
+static void tel_heaps(void) {
+#if (VERSUCH >= 3)
+    for (uint8_t i = 0; i < os_getHeapListLength(); i++) {
+        Heap *const heap = os_lookupHeap(i);
+        tel_word(os_getUseSize(heap) - os_getHeapUsage(heap));
+    }
+#endif
+}
+
+/*!
+ *  Sends a snapshot of the kernel metrics as one frame (see the file
+ *  description for the layout). The USART is locked for the whole frame,
+ *  so no shell output gets in between.
+ */
+static void tel_sendSnapshot(void) {
+    uint16_t criticalLongest;
+    uint8_t criticalDeepest;
+    os_takeCriticalSectionStats(&criticalLongest, &criticalDeepest);
+    uint16_t latencyMin, latencyMax;
+    os_takeTickLatency(&latencyMin, &latencyMax);
+
+    uint8_t const heaps = tel_heapCount();
+    uint8_t const length = 17 + 1 + 2 * heaps + 1 + 7 * MAX_NUMBER_OF_PROCESSES;
+
+    os_lockUsart();
+    os_usartPutChar(TELEMETRY_SYNC1);
+    os_usartPutChar(TELEMETRY_SYNC2);
+    frameCrc = 0xFFFF;
+    tel_byte(length);
+
+    tel_byte(TELEMETRY_VERSION);
+    tel_dword(os_systemTime_coarse());
+    tel_byte(os_getCpuUtilization());
+    tel_word(os_getContextSwitchRate());
+    tel_word(os_getLoadAverage(OS_LA_1S));
+    tel_word(criticalLongest);
+    tel_byte(criticalDeepest);
+    tel_word(latencyMin);
+    tel_word(latencyMax);
+
+    tel_byte(heaps);
+    tel_heaps();
+
+    tel_byte(MAX_NUMBER_OF_PROCESSES);
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        tel_byte(os_getProcessSlot(pid)->state);
+        tel_dword(os_getProcessCpuTime(pid));
+        tel_word(os_getStackWatermark(pid));
+    }
+
+    uint16_t const crc = frameCrc;
+    os_usartPutChar(crc);
+    os_usartPutChar(crc >> 8);
+    os_unlockUsart();
+}
+
+/*!
+ *  The program of the telemetry process: sends a snapshot every period. As
+ *  it has the lowest priority, the snapshots do not disturb the processes
+ *  they measure (except for the time the USART interrupts take).
+ */
+void os_telemetry(void) {
+    os_initUsart();
+
+    for (;;) {
+        if (!period) {
+            os_sleep(TELEMETRY_PAUSE_POLL);
+            continue;
+        }
+        tel_sendSnapshot();
+        os_sleep(period);
+    }
+}
@@ -0,0 +1,49 @@
+/*! \file
+ *  \brief Binary telemetry over USART0.
+ *
+ *  Contains a process that periodically sends a snapshot of the kernel
+ *  metrics as a CRC-protected frame. tools/spos_telemetry.py receives the
+ *  frames and writes them as CSV.
+ */
+
+#ifndef _OS_TELEMETRY_H
+#define _OS_TELEMETRY_H
+
+#include <stdint.h>
+
+#include "defines.h"
+#include "os_programs.h"
+
+//----------------------------------------------------------------------------
+// Macros
+//----------------------------------------------------------------------------
+
+//! First byte of every frame
+#define TELEMETRY_SYNC1 0xA5
+
+//! Second byte of every frame
+#define TELEMETRY_SYNC2 0x5A
+
+//! Version of the snapshot layout, the first byte of the payload
+#define TELEMETRY_VERSION 1
+
+//! Priority of the telemetry process, it only gets the processor left over
+#define TELEMETRY_PRIORITY 1
+
+//! Registry entry for the telemetry, to be listed in REGISTER_PROGRAMS
+#define TELEMETRY_PROGRAM PROGRAM("telemetry", os_telemetry, TELEMETRY_PRIORITY, STACK_SIZE_PROC, OS_PF_SINGLETON | OS_PF_SYSTEM)
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! The program of the telemetry process
+void os_telemetry(void);
+
+//! Sets the period between two snapshots
+void os_setTelemetryPeriod(uint16_t ms);
+
+//! Returns the period between two snapshots
+uint16_t os_getTelemetryPeriod(void);
+
+#endif
@@ -0,0 +1,135 @@
+/*! \file
+ *  \brief Trace of scheduling events.
+ *
+ *  Every event is stored with the low word of the system time in timer 0
+ *  counts, which wraps after about 0.8 s at the full clock. The scheduler
+ *  interrupt records at least two events per tick, so a host tool can still reconstruct
+ *  the full time line. If the buffer is full, the oldest events are
+ *  overwritten, so the trace always shows the latest history.
+ */
+
+#include "os_trace.h"
+
+#if TRACE_BUFFER_SIZE
+
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "os_format.h"
+#include "util.h"
+
+#if TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)
+#error "TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+//----------------------------------------------------------------------------
+// Private constants
+//----------------------------------------------------------------------------
+
+//! The letter every event type is written as by os_dumpTrace
+static char const eventLetters[OS_TE_COUNT] PROGMEM = {
+    [OS_TE_SWITCH] = 'S',
+    [OS_TE_BLOCK] = 'B',
+    [OS_TE_WAKE] = 'W',
+    [OS_TE_EXEC] = 'E',
+    [OS_TE_EXIT] = 'X',
+    [OS_TE_ISR_ENTER] = 'I',
+    [OS_TE_ISR_LEAVE] = 'i',
+    [OS_TE_CRITICAL_ENTER] = 'C',
+    [OS_TE_CRITICAL_LEAVE] = 'c',
+    [OS_TE_LCD_BEGIN] = 'L',
+    [OS_TE_LCD_END] = 'l',
+};
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! The recorded events
+static TraceEvent events[TRACE_BUFFER_SIZE];
+
+//! Index of the oldest event
+static uint8_t head;
+
+//! Number of recorded events
+static uint8_t fill;
+
+//! Whether events are recorded
+static bool enabled;
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Clears the trace and starts recording. Called by os_init once the system
+ *  time was reset.
+ */
+void os_initTrace(void) {
+    head = 0;
+    fill = 0;
+    enabled = true;
+}
+
+/*!
+ *  Records an event. May be called anywhere, also from interrupts.
+ *
+ *  \param type The type of the event.
+ *  \param arg The process concerned (or the TraceInterrupt).
+ */
+void os_trace(TraceEventType type, uint8_t arg) {
+    uint8_t const sreg = SREG;
+    cli();
+    if (enabled) {
+        TraceEvent *const event = &events[(head + fill) & (TRACE_BUFFER_SIZE - 1)];
+        event->time = os_systemTime_augment();
+        event->type = type;
+        event->arg = arg;
+        if (fill < TRACE_BUFFER_SIZE) {
+            fill++;
+        } else {
+            head = (head + 1) & (TRACE_BUFFER_SIZE - 1);
+        }
+    }
+    SREG = sreg;
+}
+
+/*!
+ *  Pauses or resumes recording, e.g. to keep the history before some
+ *  interesting point.
+ *
+ *  \param enable Whether events are to be recorded.
+ */
+void os_setTraceEnabled(bool enable) {
+    enabled = enable;
+}
+
+/*!
+ *  Writes the recorded events, oldest first, one per line as
+ *  "<time in hex> <letter> <argument>" and removes them from the trace. Recording
+ *  is paused meanwhile, so the dump is consistent even if the stream blocks.
+ *  The letters are S(witch), B(lock), W(ake), E(xec), e(X)it, I/i for the
+ *  start and end of an interrupt, C/c for a critical section and L/l for a
+ *  transfer to the LCD.
+ *
+ *  \param stream The stream to write to.
+ */
+void os_dumpTrace(FILE *stream) {
+    bool const wasEnabled = enabled;
+    enabled = false;
+
+    while (fill) {
+        TraceEvent const event = events[head];
+        uint8_t const sreg = SREG;
+        cli();
+        head = (head + 1) & (TRACE_BUFFER_SIZE - 1);
+        fill--;
+        SREG = sreg;
+
+        os_printf_P(stream, PSTR("%04X %c %u\r\n"), event.time, pgm_read_byte(&eventLetters[event.type]), event.arg);
+    }
+
+    enabled = wasEnabled;
+}
+
+#endif
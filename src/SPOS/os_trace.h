@@ -0,0 +1,78 @@
+/*! \file
+ *  \brief Trace of scheduling events.
+ *
+ *  Contains a ring buffer that records when processes are switched to,
+ *  block, wake up, start and terminate, as well as spans in which the
+ *  processes are held up: interrupts, critical sections and LCD transfers.
+ *  tools/spos_vcd.py turns a dump of the trace into a waveform.
+ */
+
+#ifndef _OS_TRACE_H
+#define _OS_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "defines.h"
+
+//----------------------------------------------------------------------------
+// Types
+//----------------------------------------------------------------------------
+
+//! The events the trace records, the argument is a ProcessID unless noted otherwise
+typedef enum TraceEventType {
+    OS_TE_SWITCH,           //!< The scheduler switched to the process
+    OS_TE_BLOCK,            //!< The process left the processor blocked
+    OS_TE_WAKE,             //!< The blocked process became ready
+    OS_TE_EXEC,             //!< The process was started
+    OS_TE_EXIT,             //!< The process terminated or was killed
+    OS_TE_ISR_ENTER,        //!< An interrupt started, the argument is a TraceInterrupt
+    OS_TE_ISR_LEAVE,        //!< The interrupt ended, the argument is a TraceInterrupt
+    OS_TE_CRITICAL_ENTER,   //!< The process entered the outermost critical section
+    OS_TE_CRITICAL_LEAVE,   //!< The process left the outermost critical section
+    OS_TE_LCD_BEGIN,        //!< The process started a transfer to the LCD
+    OS_TE_LCD_END,          //!< The transfer to the LCD ended
+    OS_TE_COUNT
+} TraceEventType;
+
+//! The interrupts that are traced
+typedef enum TraceInterrupt {
+    OS_TI_SCHEDULER         //!< TIMER2_COMPA_vect, also when entered by a yield
+} TraceInterrupt;
+
+//! A recorded event
+typedef struct TraceEvent {
+    uint16_t time;  //!< Low word of os_systemTime_augment
+    uint8_t type;   //!< A TraceEventType
+    uint8_t arg;    //!< The process concerned
+} TraceEvent;
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+#if TRACE_BUFFER_SIZE
+
+//! Clears the trace and starts recording
+void os_initTrace(void);
+
+//! Records an event
+void os_trace(TraceEventType type, uint8_t arg);
+
+//! Pauses or resumes recording
+void os_setTraceEnabled(bool enabled);
+
+//! Writes the recorded events as text and removes them from the trace
+void os_dumpTrace(FILE *stream);
+
+#else
+
+#define os_initTrace() ((void)0)
+#define os_trace(TYPE, ARG) ((void)0)
+#define os_setTraceEnabled(ENABLED) ((void)0)
+#define os_dumpTrace(STREAM) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,361 @@
+/*! \file
+ *  \brief Interrupt-driven driver for USART0.
+ *
+ *  Both directions are ring buffers that are filled and drained by the
+ *  interrupts of the USART, so sending text does not stall the caller for
+ *  the time the bits need on the wire. A process that has to wait for room
+ *  or for input is blocked and woken up by the interrupt. The buffers are
+ *  shared with the interrupts, so they are only accessed with interrupts
+ *  disabled.
+ *
+ *  Several processes may write, e.g. the shell and the telemetry. A process
+ *  that must not be interrupted by the others, e.g. for a whole telemetry
+ *  frame or a whole shell answer, takes the USART with os_lockUsart. Until
+ *  it unlocks it, the other writers wait in os_usartPutChar.
+ */
+
+#include "os_usart.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/power.h>
+
+#include "defines.h"
+#include "os_core.h"
+#include "os_process.h"
+#include "os_scheduler.h"
+#include "util.h"
+
+#if (USART_RX_BUFFER_SIZE & (USART_RX_BUFFER_SIZE - 1)) || (USART_TX_BUFFER_SIZE & (USART_TX_BUFFER_SIZE - 1))
+#error "The USART buffer sizes must be powers of two"
+#endif
+
+//----------------------------------------------------------------------------
+// Private function declarations
+//----------------------------------------------------------------------------
+
+//! Put function of usartio
+static int os_usartPut(char c, FILE *stream);
+
+//! Get function of usartio
+static int os_usartGet(FILE *stream);
+
+//----------------------------------------------------------------------------
+// Globals
+//----------------------------------------------------------------------------
+
+FILE *usartio = &(FILE)FDEV_SETUP_STREAM(os_usartPut, os_usartGet, _FDEV_SETUP_RW);
+
+//----------------------------------------------------------------------------
+// Private variables
+//----------------------------------------------------------------------------
+
+//! Bytes received but not read yet
+static uint8_t rxBuffer[USART_RX_BUFFER_SIZE];
+
+//! Index of the oldest byte in rxBuffer
+static uint8_t rxHead;
+
+//! Number of bytes in rxBuffer
+static volatile uint8_t rxFill;
+
+//! Bytes to send
+static uint8_t txBuffer[USART_TX_BUFFER_SIZE];
+
+//! Index of the oldest byte in txBuffer
+static uint8_t txHead;
+
+//! Number of bytes in txBuffer
+static volatile uint8_t txFill;
+
+//! Processes waiting for input
+static ProcessMask rxWaiters;
+
+//! Processes waiting for room in txBuffer
+static ProcessMask txWaiters;
+
+//! Received bytes lost because rxBuffer was full
+static uint8_t overruns;
+
+//! Process that locked the USART or INVALID_PROCESS
+static ProcessID owner = INVALID_PROCESS;
+
+//! Number of times the owner locked the USART
+static uint8_t ownerLocks;
+
+//! Processes waiting for the owner to unlock the USART
+static ProcessMask ownerWaiters;
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+
+/*!
+ *  Powers up USART0 and configures it for 8N1 at USART_BAUD_RATE. Does
+ *  nothing if the USART is running already, so every user of the USART may
+ *  call it.
+ */
+void os_initUsart(void) {
+    if (gbi(UCSR0B, RXEN0)) {
+        return;
+    }
+
+    power_usart0_enable();
+    rxHead = rxFill = 0;
+    txHead = txFill = 0;
+    rxWaiters = txWaiters = 0;
+    overruns = 0;
+    owner = INVALID_PROCESS;
+    ownerLocks = 0;
+    ownerWaiters = 0;
+
+    UCSR0A = _BV(U2X0);
+    os_refreshUsartBaudRate();
+    UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);
+    UCSR0B = _BV(RXCIE0) | _BV(RXEN0) | _BV(TXEN0);
+}
+
+/*!
+ *  Sets the baud rate generator for USART_BAUD_RATE at the current division
+ *  of the system clock. Called by os_setClockDivision, as the USART is
+ *  clocked by the divided system clock. Does nothing while the USART is
+ *  powered down.
+ */
+void os_refreshUsartBaudRate(void) {
+    if (gbi(PRR, PRUSART0)) {
+        return;
+    }
+    uint32_t const clock = F_CPU >> os_getClockDivision();
+    uint32_t const divisor = (clock + 4 * USART_BAUD_RATE) / (8 * USART_BAUD_RATE);
+    UBRR0 = divisor ? divisor - 1 : 0;
+}
+
+/*!
+ *  Blocks the calling process until it is woken up by one of the interrupts.
+ *  Must be called with interrupts disabled, which they are again on return.
+ *
+ *  \param waiting The processes waiting for the same event as the caller.
+ */
+static void os_usartWait(ProcessMask *waiting) {
+    ProcessID const self = os_getCurrentProc();
+    *waiting |= 1 << self;
+    os_getProcessSlot(self)->state = OS_PS_BLOCKED;
+    sei();
+    // The interrupt might have woken us meanwhile
+    if (os_getProcessSlot(self)->state == OS_PS_BLOCKED) {
+        os_yield();
+    }
+    cli();
+    *waiting &= ~(1 << self);
+}
+
+/*!
+ *  Unblocks every process in the mask. Called by the interrupts.
+ *
+ *  \param waiting The processes to wake up.
+ */
+static void os_usartWake(ProcessMask waiting) {
+    for (ProcessID pid = 0; waiting; pid++, waiting >>= 1) {
+        if (waiting & 1) {
+            os_unblockFromISR(pid);
+        }
+    }
+}
+
+/*!
+ *  Checks whether the calling process has to wait for the USART instead of
+ *  sending right away: it has to if another process locked the USART, but
+ *  not with interrupts disabled, inside a critical section or as the idle
+ *  process. None of them can be switched out, so waiting would never end.
+ *
+ *  \param sreg The status register of the caller.
+ *  \return True, iff the caller may block.
+ */
+static bool os_usartMayBlock(uint8_t sreg) {
+    return (sreg & _BV(SREG_I)) && !os_isInCriticalSection() && os_getCurrentProc() != 0;
+}
+
+/*!
+ *  Appends a byte to the send buffer. If another process locked the USART,
+ *  the calling process is blocked until it is unlocked. If the buffer is
+ *  full, the calling process is blocked until the USART sent enough. With
+ *  interrupts disabled, inside a critical section or from the idle process,
+ *  which all must not block, the lock is ignored and the oldest byte is sent
+ *  right away instead, so e.g. error messages work everywhere.
+ *
+ *  \param byte The byte to send.
+ */
+void os_usartPutChar(uint8_t byte) {
+    uint8_t const sreg = SREG;
+    cli();
+    while (owner != INVALID_PROCESS && owner != os_getCurrentProc() && os_usartMayBlock(sreg)) {
+        os_usartWait(&ownerWaiters);
+    }
+    while (txFill == USART_TX_BUFFER_SIZE) {
+        if (!os_usartMayBlock(sreg)) {
+            loop_until_bit_is_set(UCSR0A, UDRE0);
+            UDR0 = txBuffer[txHead];
+            txHead = (txHead + 1) & (USART_TX_BUFFER_SIZE - 1);
+            txFill--;
+        } else {
+            os_usartWait(&txWaiters);
+        }
+    }
+    txBuffer[(txHead + txFill) & (USART_TX_BUFFER_SIZE - 1)] = byte;
+    txFill++;
+    sbi(UCSR0B, UDRIE0);
+    SREG = sreg;
+}
+
+/*!
+ *  Takes the oldest received byte. If there is none, the calling process is
+ *  blocked until one arrives. Must not be called by the idle process or
+ *  with interrupts disabled.
+ *
+ *  \return The byte received.
+ */
+uint8_t os_usartGetChar(void) {
+    uint8_t const sreg = SREG;
+    cli();
+    while (!rxFill) {
+        os_usartWait(&rxWaiters);
+    }
+    uint8_t const byte = rxBuffer[rxHead];
+    rxHead = (rxHead + 1) & (USART_RX_BUFFER_SIZE - 1);
+    rxFill--;
+    SREG = sreg;
+    return byte;
+}
+
+/*!
+ *  A simple getter for the number of received bytes.
+ *
+ *  \return The number of bytes os_usartGetChar returns without waiting.
+ */
+uint8_t os_usartAvailable(void) {
+    return rxFill;
+}
+
+/*!
+ *  A simple getter for the lost bytes.
+ *
+ *  \return The number of received bytes dropped because the receive buffer
+ *          was full (saturating at 255).
+ */
+uint8_t os_getUsartOverruns(void) {
+    return overruns;
+}
+
+/*!
+ *  Makes the calling process the only writer of the USART, e.g. to send a
+ *  frame or a line that must not be mixed with the output of others. Waits
+ *  while another process holds the lock. The owner may lock again, the
+ *  USART is free once it unlocked as often as it locked. Must not be called
+ *  by the idle process, inside a critical section or with interrupts disabled.
+ */
+void os_lockUsart(void) {
+    uint8_t const sreg = SREG;
+    cli();
+    ProcessID const self = os_getCurrentProc();
+    while (owner != INVALID_PROCESS && owner != self) {
+        os_usartWait(&ownerWaiters);
+    }
+    owner = self;
+    ownerLocks++;
+    SREG = sreg;
+}
+
+/*!
+ *  Frees the USART and wakes up the waiting writers.
+ */
+static void os_usartFree(void) {
+    owner = INVALID_PROCESS;
+    ownerLocks = 0;
+    os_usartWake(ownerWaiters);
+}
+
+/*!
+ *  Undoes one os_lockUsart of the calling process. Does nothing if the
+ *  caller does not hold the lock.
+ */
+void os_unlockUsart(void) {
+    uint8_t const sreg = SREG;
+    cli();
+    if (owner == os_getCurrentProc() && !--ownerLocks) {
+        os_usartFree();
+    }
+    SREG = sreg;
+}
+
+/*!
+ *  Removes a terminated process from the waiting readers and writers and
+ *  frees the USART if the process held it. Called with the scheduler
+ *  disabled.
+ *
+ *  \param pid The terminated process.
+ */
+void os_releaseProcessUsart(ProcessID pid) {
+    uint8_t const sreg = SREG;
+    cli();
+    rxWaiters &= ~(1 << pid);
+    txWaiters &= ~(1 << pid);
+    ownerWaiters &= ~(1 << pid);
+    if (owner == pid) {
+        os_usartFree();
+    }
+    SREG = sreg;
+}
+
+/*!
+ *  Writes a character to the USART, stdio style.
+ *
+ *  \param c The character to write.
+ *  \param stream Not used.
+ *  \return Always 0.
+ */
+static int os_usartPut(char c, FILE *stream) {
+    os_usartPutChar(c);
+    return 0;
+}
+
+/*!
+ *  Reads a character from the USART, stdio style.
+ *
+ *  \param stream Not used.
+ *  \return The character read.
+ */
+static int os_usartGet(FILE *stream) {
+    return os_usartGetChar();
+}
+
+/*!
+ *  A byte was received: it is buffered (or dropped if nobody made room in
+ *  time) and the waiting readers are woken up.
+ */
+ISR(USART0_RX_vect) {
+    uint8_t const byte = UDR0;
+    if (rxFill < USART_RX_BUFFER_SIZE) {
+        rxBuffer[(rxHead + rxFill) & (USART_RX_BUFFER_SIZE - 1)] = byte;
+        rxFill++;
+    } else if (overruns < UINT8_MAX) {
+        overruns++;
+    }
+    os_usartWake(rxWaiters);
+    os_reschedFromISR();
+}
+
+/*!
+ *  The data register is empty: the next byte is sent and the waiting writers
+ *  are woken up. Once the buffer is empty, the interrupt disables itself.
+ */
+ISR(USART0_UDRE_vect) {
+    if (!txFill) {
+        cbi(UCSR0B, UDRIE0);
+        return;
+    }
+    UDR0 = txBuffer[txHead];
+    txHead = (txHead + 1) & (USART_TX_BUFFER_SIZE - 1);
+    txFill--;
+    os_usartWake(txWaiters);
+    os_reschedFromISR();
+}
@@ -0,0 +1,55 @@
+/*! \file
+ *  \brief Interrupt-driven driver for USART0.
+ *
+ *  Contains buffered sending and receiving over the serial port, both
+ *  directly and as a stdio stream.
+ */
+
+#ifndef _OS_USART_H
+#define _OS_USART_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "os_process.h"
+
+//----------------------------------------------------------------------------
+// Globals
+//----------------------------------------------------------------------------
+
+//! Stream for reading from and writing to USART0
+extern FILE *usartio;
+
+//----------------------------------------------------------------------------
+// Function headers
+//----------------------------------------------------------------------------
+
+//! Powers up USART0 and enables the receiver and the transmitter
+void os_initUsart(void);
+
+//! Adapts the baud rate generator to the current clock division
+void os_refreshUsartBaudRate(void);
+
+//! Sends a byte, waiting while the send buffer is full
+void os_usartPutChar(uint8_t byte);
+
+//! Receives a byte, waiting until one arrived
+uint8_t os_usartGetChar(void);
+
+//! Number of received bytes that can be read without waiting
+uint8_t os_usartAvailable(void);
+
+//! Number of received bytes lost because nobody read them in time
+uint8_t os_getUsartOverruns(void);
+
+//! Makes the calling process the only writer until it calls os_unlockUsart
+void os_lockUsart(void);
+
+//! Gives up the USART taken by os_lockUsart
+void os_unlockUsart(void);
+
+//! Removes a terminated process from the waiting readers and writers
+void os_releaseProcessUsart(ProcessID pid);
+
+#endif
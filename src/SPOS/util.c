@@ -19,6 +19,16 @@
  */
 static Time os_systemTime_overflows = 0;
 
+/*!
+ * System time in timer 0 counts at the full clock (F_CPU) that passed before the last clock change.
+ */
+static Time os_systemTime_base = 0;
+
+/*!
+ * Binary logarithm of the current system clock division (see os_systemTime_rescale).
+ */
+static uint8_t os_systemTime_clockShift = 0;
+
 /*!
  * ISR that counts the number of occurred Timer 0 overflows for the os_systemTime_[coarse|precise] functions.
  */
@@ -31,6 +41,23 @@ ISR(TIMER0_OVF_vect) {
  */
 void os_systemTime_reset(void){
     os_systemTime_overflows = 0;
+    os_systemTime_base = 0;
+}
+
+/*!
+ * Function to be called (with interrupts disabled) right before the system clock is divided by 2^clockShift.
+ * Timer 0 counts slower at a divided clock, so the time counted so far is folded into os_systemTime_base
+ * (converted to counts at the full clock) and the counting restarts. That way all conversions may keep
+ * using F_CPU.
+ *
+ * \param clockShift The binary logarithm of the new clock division
+ */
+void os_systemTime_rescale(uint8_t clockShift) {
+    os_systemTime_base = os_systemTime_augment();
+    os_systemTime_overflows = 0;
+    TCNT0 = 0;
+    TIFR0 = (1<<TOV0);
+    os_systemTime_clockShift = clockShift;
 }
 
 /*!
@@ -41,18 +68,19 @@ void os_systemTime_reset(void){
 */
 Time os_systemTime_coarse(void) {
     /*! calculation performed:
-     *   os_systemTime_overflows*1000                /(F_CPU/TC0_PRESCALER/256)
-     *   timercounts            |   mult to get ms   | to get from freq to time 
+     *   os_systemTime_base + os_systemTime_overflows*256*2^shift  /(F_CPU/(TC0_PRESCALER*1000))
+     *   timercounts at the full clock                              | to get from freq to ms
      */
-    return os_systemTime_overflows * 1000 / (F_CPU/TC0_PRESCALER/256);
+    return (os_systemTime_base + (os_systemTime_overflows << (8 + os_systemTime_clockShift))) / (F_CPU/(TC0_PRESCALER*1000ul));
 } 
 
 /*!
  * Function augments os_systemTime_overflows to increase precision to approx 13 us (presc/f_cpu = 256/20MHz)
+ * Also useful to measure short intervals without the cost of converting to ms.
  *
- * \return os_systemTime_overflows scaled by cpu speed , timer prescaler as well as register size
+ * \return The system time in timer 0 counts at the full clock (F_CPU), no matter the current clock division
  */
-static Time os_systemTime_augment(void) {
+Time os_systemTime_augment(void) {
     /*! in case Interrupts are off and the overflow flag is activated we simulate the overflow interrupt.
      *  The flag signalizes, that an overflow occurred. This would have been handled by the ISR immediately
      *  but since the interrupts are off, the controller will wait until they come back on. However,
@@ -68,7 +96,7 @@ static Time os_systemTime_augment(void) {
      *   resolution of 3.3 ms and augment it with the current TCNT0 counter register, yielding
      *   a resolution of ~ 13 us.
      */
-    return ((os_systemTime_overflows<<8) | TCNT0);
+    return os_systemTime_base + (((os_systemTime_overflows<<8) | TCNT0) << os_systemTime_clockShift);
 }
 
 /*!
@@ -27,12 +27,18 @@ typedef uint32_t Time;
 //! Resets system time back to 0
 void os_systemTime_reset(void);
 
+//! Keeps the system time correct across a change of the system clock division
+void os_systemTime_rescale(uint8_t clockShift);
+
 //! Coarse system time in ms
 Time os_systemTime_coarse(void);
 
 //! Precise system time in ms
 Time os_systemTime_precise(void);
 
+//! System time in counts of timer 0 (TC0_PRESCALER clock cycles each)
+Time os_systemTime_augment(void);
+
 //! Waits for some milliseconds
 void delayMs(Time ms);
 
@@ -60,6 +66,9 @@ bool assertPstr(bool exp, char const* errormsg);
 #define TIME_M_TO_MS(m)     (TIME_S_TO_MS(m *  60ul))
 #define TIME_H_TO_MS(h)     (TIME_M_TO_MS(h *  60ul))
 
+//! Timer 0 counts per millisecond, the unit of os_systemTime_augment
+#define TIME_COUNTS_PER_MS  (F_CPU / (TC0_PRESCALER * 1000ul))
+
 //----------------------------------------------------------------------------
 // Assembler macros
 //----------------------------------------------------------------------------
@@ -0,0 +1,106 @@
+//-------------------------------------------------
+//          TestTask: Shell
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_programs.h"
+#include "os_scheduler.h"
+#include "os_shell.h"
+#include "os_telemetry.h"
+
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#if VERSUCH < 3
+    #error "Please fix the VERSUCH-define"
+#endif
+
+#ifndef WRITE
+    #define WRITE(str) lcd_writeProgString(PSTR(str))
+#endif
+#define TEST_PASSED \
+    do ATOMIC { \
+        lcd_clear(); \
+        WRITE("  TEST PASSED   "); \
+    } while (0)
+#define TEST_FAILED(reason) \
+    do ATOMIC { \
+        lcd_clear(); \
+        WRITE("FAIL  "); \
+        WRITE(reason); \
+    } while (0)
+#define TEST_ASSERT(predicate, reason) \
+    do { \
+        if (!(predicate)) { \
+            TEST_FAILED(reason); \
+            HALT; \
+        } \
+    } while (0)
+
+void program_shell(void);
+void counter(void);
+void busy(void);
+
+/*
+ *  The shell is started through its OS_PF_AUTOSTART flag, the telemetry by
+ *  the shell's "telem" command. The other two programs are meant to be
+ *  started from the shell, e.g. with
+ *      tools/spos_shell.py /tmp/simavr-uart0 progs "run counter" ps "kill 3"
+ *  shell_test.py runs such a ps/run/kill round trip and checks the answers.
+ */
+REGISTER_PROGRAMS(
+    SHELL_PROGRAM,
+    TELEMETRY_PROGRAM,
+    PROGRAM("counter", counter, DEFAULT_PRIORITY, 64, OS_PF_SINGLETON),
+    PROGRAM("busy", busy, DEFAULT_PRIORITY, 64, 0),
+)
+REGISTER_AUTOSTART(program_shell)
+
+//! Counts the seconds it runs on the second line of the LCD
+void counter(void) {
+    for (uint16_t seconds = 0;; seconds++) {
+        ATOMIC {
+            lcd_goto(2, 1);
+            lcd_writeDec(seconds);
+        }
+        os_sleep(1000);
+    }
+}
+
+//! Uses all the CPU time it gets, e.g. to watch 'ps' and 'nice'
+void busy(void) {
+    while (1) {
+    }
+}
+
+/*!
+ *  Checks that the registered shell was started in SYSTEM_GROUP, runs only
+ *  once and waits for input without using the processor. Then it ends and
+ *  leaves the shell to the serial port.
+ */
+void program_shell(void) {
+    lcd_clear();
+    WRITE("Shell");
+
+    ProgramID const id = os_lookupProgram("shell");
+    TEST_ASSERT(id != INVALID_PROGRAM, "Not registered");
+    ProcessID shell = INVALID_PROCESS;
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        if (os_getProcessSlot(pid)->program == os_shell) {
+            TEST_ASSERT(shell == INVALID_PROCESS, "Two shells");
+            shell = pid;
+        }
+    }
+    TEST_ASSERT(shell != INVALID_PROCESS, "Not started");
+    TEST_ASSERT(os_getProcessSlot(shell)->group == SYSTEM_GROUP, "Wrong group");
+    TEST_ASSERT(os_execProgram(id) == INVALID_PROCESS, "Second shell");
+
+    // Give the shell the time to greet, then it has to wait for a line
+    os_sleep(500);
+    TEST_ASSERT(os_getProcessSlot(shell)->state == OS_PS_BLOCKED, "Not blocked");
+
+    TEST_PASSED;
+}
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Starts and kills a program through the shell of test 10.
+
+Runs ps, run and kill through tools/spos_shell.py and checks that each
+answer matches the process table the next ps shows. The test program
+must be running, e.g. in simavr with its UART on a pty.
+
+Usage: shell_test.py DEVICE
+
+DEVICE is the serial device of the shell, e.g. /tmp/simavr-uart0.
+"""
+
+import os
+import signal
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "tools"))
+
+from spos_shell import Shell  # noqa: E402
+
+TIMEOUT = 10  # seconds the shell gets to answer a command
+
+
+def fail(reason):
+    sys.exit("FAIL " + reason)
+
+
+def run(shell, command):
+    """Runs a command and returns its output lines."""
+    signal.alarm(TIMEOUT)
+    output = shell.run(command)
+    signal.alarm(0)
+    return output.splitlines()
+
+
+def ps(shell):
+    """Maps the pid of every process to its state letter and program."""
+    lines = run(shell, "ps")
+    if not lines or lines[0].split() != ["PID", "S", "PRIO", "CPU", "STACK", "PROG"]:
+        fail("ps header: %r" % lines[:1])
+    processes = {}
+    for line in lines[1:]:
+        fields = line.split()
+        if len(fields) != 6:
+            fail("ps row: %r" % line)
+        processes[int(fields[0])] = (fields[1], fields[5])
+    return processes
+
+
+def main(argv):
+    if len(argv) != 2:
+        sys.exit(__doc__)
+    signal.signal(signal.SIGALRM, lambda signum, frame: fail("no prompt"))
+    signal.alarm(TIMEOUT)
+    shell = Shell(argv[1])
+    # Get a fresh prompt, no matter what was typed before
+    os.write(shell.fd, b"\r")
+    shell.read_until_prompt()
+    shell.drain()
+    signal.alarm(0)
+
+    before = ps(shell)
+    if "shell" not in (program for _, program in before.values()):
+        fail("shell not listed")
+    if "counter" in (program for _, program in before.values()):
+        fail("counter already running")
+
+    answer = run(shell, "run counter")
+    if len(answer) != 1 or not answer[0].startswith("pid "):
+        fail("run: %r" % answer)
+    pid = int(answer[0][4:])
+    running = ps(shell)
+    if running.get(pid, ("", ""))[1] != "counter":
+        fail("counter not listed as pid %u" % pid)
+    if run(shell, "run counter") != ["failed"]:
+        fail("second counter started")
+
+    if run(shell, "kill %u" % pid) != ["killed"]:
+        fail("kill")
+    if pid in ps(shell):
+        fail("counter still listed")
+    if run(shell, "kill %u" % pid) != ["failed"]:
+        fail("killed twice")
+
+    print("TEST PASSED")
+
+
+if __name__ == "__main__":
+    main(sys.argv)
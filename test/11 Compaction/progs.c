@@ -0,0 +1,147 @@
+//-------------------------------------------------
+//          TestTask: Compaction
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_handles.h"
+#include "os_memory.h"
+#include "os_programs.h"
+#include "os_scheduler.h"
+
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#if VERSUCH < 3
+    #error "Please fix the VERSUCH-define"
+#endif
+
+#ifndef WRITE
+    #define WRITE(str) lcd_writeProgString(PSTR(str))
+#endif
+#define TEST_PASSED \
+    do ATOMIC { \
+        lcd_clear(); \
+        WRITE("  TEST PASSED   "); \
+    } while (0)
+#define TEST_FAILED(reason) \
+    do ATOMIC { \
+        lcd_clear(); \
+        WRITE("FAIL  "); \
+        WRITE(reason); \
+    } while (0)
+#define TEST_ASSERT(predicate, reason) \
+    do { \
+        if (!(predicate)) { \
+            TEST_FAILED(reason); \
+            HALT; \
+        } \
+    } while (0)
+
+//---- Adjust here what to test -------------------
+// Number of movable blocks the heap is fragmented with (even)
+#define BLOCKS          MAX_NUMBER_OF_HANDLES
+// The block that stays locked while the compactor runs (odd)
+#define PINNED          (BLOCKS / 2 - 1)
+// Time in ms the compactor gets to close the holes
+#define TIMEOUT         5000
+//-------------------------------------------------
+
+void program_compaction(void);
+
+REGISTER_PROGRAMS(
+    COMPACTOR_PROGRAM,
+    PROGRAM("compaction", program_compaction, DEFAULT_PRIORITY, STACK_SIZE_PROC, OS_PF_AUTOSTART | OS_PF_SINGLETON | OS_PF_HIDDEN),
+)
+
+Heap *const heap = intHeap;
+MemHandle handles[BLOCKS];
+uint16_t blockSize;
+
+//! Fills a block with its number
+void fill(uint8_t block) {
+    MemAddr const addr = os_lockHandle(handles[block]);
+    for (uint16_t i = 0; i < blockSize; i++) {
+        heap->driver->write(addr + i, block);
+    }
+    os_unlockHandle(handles[block]);
+}
+
+//! Checks that a block still holds its number
+void check(uint8_t block) {
+    MemAddr const addr = os_lockHandle(handles[block]);
+    TEST_ASSERT(os_getHandleSize(handles[block]) == blockSize, "Wrong size");
+    for (uint16_t i = 0; i < blockSize; i++) {
+        TEST_ASSERT(heap->driver->read(addr + i) == block, "Data lost");
+    }
+    os_unlockHandle(handles[block]);
+}
+
+/*!
+ *  Fills the internal heap with movable blocks followed by an immovable
+ *  allocation and frees every other block, so no hole is larger than a
+ *  block. Then it waits for the compactor (with one block locked) until a
+ *  plain allocation of four blocks succeeds, and checks that the locked
+ *  block was not moved and no data was lost. Finally os_hmalloc has to find
+ *  room for half of the blocks by compacting around the unlocked block.
+ */
+void program_compaction(void) {
+    lcd_clear();
+    WRITE("Compaction");
+    os_setAllocationStrategy(heap, OS_MEM_FIRST);
+    blockSize = os_getUseSize(heap) / 2 / BLOCKS;
+    TEST_ASSERT(blockSize, "Heap too small");
+
+    // Fragment
+    for (uint8_t block = 0; block < BLOCKS; block++) {
+        handles[block] = os_hmalloc(heap, blockSize);
+        TEST_ASSERT(handles[block] != INVALID_HANDLE, "No handle");
+        fill(block);
+    }
+    MemAddr const end = os_getUseStart(heap) + os_getUseSize(heap);
+    MemAddr const last = os_lockHandle(handles[BLOCKS - 1]);
+    os_unlockHandle(handles[BLOCKS - 1]);
+    TEST_ASSERT(last == os_getUseStart(heap) + (BLOCKS - 1) * blockSize, "Not in a row");
+    MemAddr const filler = os_malloc(heap, end - last - blockSize);
+    TEST_ASSERT(filler, "No filler");
+    for (uint8_t block = 0; block < BLOCKS; block += 2) {
+        os_hfree(handles[block]);
+    }
+    TEST_ASSERT(!os_malloc(heap, 4 * blockSize), "Not fragmented");
+
+    // Compact in the background
+    lcd_line2();
+    WRITE("Background ");
+    MemAddr const pinned = os_lockHandle(handles[PINNED]);
+    MemAddr large = 0;
+    for (uint16_t waited = 0; !large; waited += 100) {
+        TEST_ASSERT(waited < TIMEOUT, "Timeout");
+        os_sleep(100);
+        large = os_malloc(heap, 4 * blockSize);
+    }
+    TEST_ASSERT(os_lockHandle(handles[PINNED]) == pinned, "Pinned moved");
+    os_unlockHandle(handles[PINNED]);
+    os_unlockHandle(handles[PINNED]);
+    for (uint8_t block = 1; block < BLOCKS; block += 2) {
+        check(block);
+    }
+    os_free(heap, large);
+
+    // Compact on demand
+    WRITE("Sync");
+    MemHandle const half = os_hmalloc(heap, BLOCKS / 2 * blockSize);
+    TEST_ASSERT(half != INVALID_HANDLE, "hmalloc failed");
+    for (uint8_t block = 1; block < BLOCKS; block += 2) {
+        check(block);
+        os_hfree(handles[block]);
+    }
+    os_hfree(half);
+    os_free(heap, filler);
+    TEST_ASSERT(!os_getHeapUsage(heap), "Memory leaked");
+
+    delayMs(10 * DEFAULT_OUTPUT_DELAY);
+    TEST_PASSED;
+    HALT;
+}
@@ -0,0 +1,296 @@
+//-------------------------------------------------
+//          TestTask: Scheduling Behaviour
+//-------------------------------------------------
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "lcd.h"
+#include "util.h"
+#include "os_scheduler.h"
+#include "os_scheduling_strategies.h"
+
+#if VERSUCH < 3
+    #error "Please fix the VERSUCH-define"
+#endif
+
+//---- Adjust here what to test -------------------
+#define TEST_SS_FAIR_SHARE          1
+#define TEST_SS_MLFQ                1
+#define TEST_SS_COMPLETELY_FAIR     1
+#define TEST_SS_CYCLIC_EXECUTIVE    1
+//-------------------------------------------------
+
+#ifndef WRITE
+    #define WRITE(str) lcd_writeProgString(PSTR(str))
+#endif
+#define TEST_PASSED \
+    do ATOMIC { \
+        lcd_clear(); \
+        WRITE("  TEST PASSED   "); \
+    } while (0)
+#define TEST_FAILED(reason) \
+    do ATOMIC { \
+        lcd_clear(); \
+        WRITE("FAIL  "); \
+        WRITE(reason); \
+    } while (0)
+#define TEST_ASSERT(predicate, reason) \
+    do { \
+        if (!(predicate)) { \
+            TEST_FAILED(reason); \
+            HALT; \
+        } \
+    } while (0)
+
+ISR(TIMER2_COMPA_vect);
+
+extern SchedulingInformation schedulingInfo[MAX_NUMBER_OF_PROCESSES];
+
+// An artificial processes array the strategies are called on directly
+Process processes[MAX_NUMBER_OF_PROCESSES];
+
+// How often each process of the artificial array was chosen
+uint8_t counts[MAX_NUMBER_OF_PROCESSES];
+
+//! Makes the processes in the bit set ready and all others unused
+void setProcesses(uint8_t ready) {
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        processes[pid].state = (ready & (1 << pid)) ? OS_PS_READY : OS_PS_UNUSED;
+        processes[pid].priority = DEFAULT_PRIORITY;
+        processes[pid].group = DEFAULT_GROUP;
+    }
+}
+
+//! Activates a strategy with fresh scheduling information and clears the counts
+void startStrategy(SchedulingStrategy strategy, char const *name) {
+    lcd_clear();
+    lcd_writeProgString(name);
+    delayMs(8 * DEFAULT_OUTPUT_DELAY);
+    os_setSchedulingStrategy(strategy);
+    memset(counts, 0, sizeof(counts));
+}
+
+//! Shows that the running strategy passed
+void strategyPassed(void) {
+    lcd_line2();
+    lcd_writeProgString(PSTR("OK"));
+    delayMs(10 * DEFAULT_OUTPUT_DELAY);
+}
+
+//! Calls the active strategy once on the artificial processes array
+ProcessID schedule(ProcessID current) {
+    switch (os_getSchedulingStrategy()) {
+        case OS_SS_FAIR_SHARE:
+            return os_Scheduler_FairShare(processes, current);
+        case OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE:
+            return os_Scheduler_MLFQ(processes, current);
+        case OS_SS_COMPLETELY_FAIR:
+            return os_Scheduler_CompletelyFair(processes, current);
+        case OS_SS_CYCLIC_EXECUTIVE:
+            return os_Scheduler_CyclicExecutive(processes, current);
+        default:
+            return 0;
+    }
+}
+
+//! Calls the active strategy the given number of times and counts its choices
+ProcessID run(ProcessID current, uint8_t calls) {
+    while (calls--) {
+        current = schedule(current);
+        counts[current]++;
+    }
+    return current;
+}
+
+//! Tests if two counts differ by at most one
+bool near(uint8_t a, uint8_t b) {
+    return abs((int16_t)a - (int16_t)b) <= 1;
+}
+
+#if TEST_SS_FAIR_SHARE
+//! Group 1 with two processes gets three times the processor time of group 2 with two processes
+void testFairShare(void) {
+    startStrategy(OS_SS_FAIR_SHARE, PSTR("FairShare"));
+    setProcesses(0b11110);
+    processes[1].group = 1;
+    processes[1].priority = 1;
+    processes[2].group = 1;
+    processes[2].priority = 3;
+    processes[3].group = 2;
+    processes[4].group = 2;
+    os_setGroupShares(1, 3);
+    os_setGroupShares(2, 1);
+
+    run(0, 64);
+    TEST_ASSERT(counts[0] == 0, "Idle ran");
+    TEST_ASSERT(counts[1] + counts[2] == 48 && counts[3] + counts[4] == 16, "Group shares");
+    // Within a group the processes are weighted by their priority + 1
+    TEST_ASSERT(near(2 * counts[1], counts[2]), "Process weights");
+    TEST_ASSERT(near(counts[3], counts[4]), "Equal processes");
+
+    os_setGroupShares(1, DEFAULT_GROUP_SHARES);
+    os_setGroupShares(2, DEFAULT_GROUP_SHARES);
+    strategyPassed();
+}
+#endif
+
+#if TEST_SS_MLFQ
+//! Processes move down a queue when their quantum expires and up when they block
+void testMLFQ(void) {
+    startStrategy(OS_SS_MULTI_LEVEL_FEEDBACK_QUEUE, PSTR("MLFQ"));
+    setProcesses(0b110);
+
+    // Both start in the top queue with a quantum of one scheduler call
+    ProcessID current = schedule(0);
+    TEST_ASSERT(current == 1, "Queue order");
+    current = schedule(current);
+    TEST_ASSERT(current == 2 && schedulingInfo[1].mlfq.level == 1, "No demotion");
+    current = schedule(current);
+    TEST_ASSERT(current == 1 && schedulingInfo[2].mlfq.level == 1, "No demotion");
+
+    // The second queue has a quantum of two scheduler calls
+    current = schedule(current);
+    TEST_ASSERT(current == 1 && schedulingInfo[1].mlfq.level == 1, "Quantum short");
+    current = schedule(current);
+    TEST_ASSERT(current == 2 && schedulingInfo[1].mlfq.level == 2, "No demotion");
+
+    // A process that blocks before its quantum expires moves up
+    processes[2].state = OS_PS_BLOCKED;
+    current = schedule(current);
+    TEST_ASSERT(current == 1 && schedulingInfo[2].mlfq.level == 0, "No promotion");
+
+    // Once ready again, it preempts the process in the lower queue
+    processes[2].state = OS_PS_READY;
+    current = schedule(current);
+    TEST_ASSERT(current == 2, "No preemption");
+    strategyPassed();
+}
+#endif
+
+#if TEST_SS_COMPLETELY_FAIR
+//! Processor time is proportional to priority + 1 and late processes cannot catch up
+void testCompletelyFair(void) {
+    startStrategy(OS_SS_COMPLETELY_FAIR, PSTR("CompletelyFair"));
+    setProcesses(0b110);
+    processes[1].priority = 1;
+    processes[2].priority = 3;
+
+    ProcessID current = run(0, 60);
+    TEST_ASSERT(near(counts[1], 20) && near(counts[2], 40), "Not proportional");
+    // Equal shares leave the virtual runtimes at most one step apart
+    uint32_t const lag = labs((int32_t)(schedulingInfo[1].vruntime - schedulingInfo[2].vruntime));
+    TEST_ASSERT(lag <= 0xFFFF / 2, "Vruntime drift");
+
+    // A process that becomes runnable starts at the current minimum
+    processes[3].state = OS_PS_READY;
+    processes[3].priority = 1;
+    memset(counts, 0, sizeof(counts));
+    run(current, 16);
+    TEST_ASSERT(counts[3] <= 5, "Late catch-up");
+    strategyPassed();
+}
+#endif
+
+#if TEST_SS_CYCLIC_EXECUTIVE
+#define CYCLIC_FRAMES 6
+
+// The controller runs in frames 0 and 3, the two workers in the others
+#define CYCLIC_TASKS(TASK, ARG) \
+    TASK(ARG, 1, 0b001001)      \
+    TASK(ARG, 2, 0b100010)      \
+    TASK(ARG, 3, 0b010100)
+REGISTER_CYCLIC_SCHEDULE(CYCLIC_TASKS, CYCLIC_FRAMES);
+
+// The process of each minor frame
+const ProcessID frames[CYCLIC_FRAMES] PROGMEM = {1, 2, 3, 1, 3, 2};
+
+// The processes that ran while the controller waited for two major frames
+const ProcessID expectedRuns[] PROGMEM = {2, 3, 3, 2, 2, 3, 3, 2};
+
+#define CAPTURE_SIZE (sizeof(expectedRuns) / sizeof(expectedRuns[0]))
+
+volatile ProcessID capture[CAPTURE_SIZE];
+volatile uint8_t captureIndex = 0;
+
+//! Records its process id once per minor frame
+void worker(void) {
+    while (1) {
+        if (captureIndex < CAPTURE_SIZE) {
+            capture[captureIndex++] = os_getCurrentProc();
+        }
+        TIMER2_COMPA_vect();
+    }
+}
+
+//! Every scheduler call starts the next minor frame, only the owner runs in it, and yields stay in the frame
+void testCyclicExecutive(void) {
+    startStrategy(OS_SS_CYCLIC_EXECUTIVE, PSTR("CyclicExecutive"));
+
+    // Frames of processes that cannot run are left to the idle process
+    setProcesses(0b1110);
+    for (uint8_t round = 0; round < 2; round++) {
+        for (uint8_t i = 0; i < 2 * CYCLIC_FRAMES; i++) {
+            ProcessID const expected = pgm_read_byte(&frames[i % CYCLIC_FRAMES]);
+            ProcessID const next = schedule(1);
+            TEST_ASSERT(next == (processes[expected].state == OS_PS_READY ? expected : 0), "Frame order");
+        }
+        processes[3].state = OS_PS_UNUSED;
+    }
+
+    // Run the schedule through the scheduler with the workers in their frames
+    os_setSchedulingStrategy(OS_SS_CYCLIC_EXECUTIVE);
+    TEST_ASSERT(os_getCurrentProc() == 1, "Controller pid");
+    TEST_ASSERT(os_exec(worker, DEFAULT_PRIORITY) == 2, "Worker pid");
+    TEST_ASSERT(os_exec(worker, DEFAULT_PRIORITY) == 3, "Worker pid");
+
+    // Start frame 0 of the controller, then yield within it
+    TIMER2_COMPA_vect();
+    for (uint8_t i = 0; i < 3; i++) {
+        os_yield();
+    }
+    TEST_ASSERT(captureIndex == 0, "Yield left frame");
+
+    // Each call hands the following frames to the workers until frame 3 or 0 returns here
+    for (uint8_t i = 0; i < 4; i++) {
+        TIMER2_COMPA_vect();
+    }
+    TEST_ASSERT(captureIndex == CAPTURE_SIZE, "Frames missed");
+    for (uint8_t i = 0; i < CAPTURE_SIZE; i++) {
+        TEST_ASSERT(capture[i] == pgm_read_byte(&expectedRuns[i]), "Frame order");
+    }
+
+    os_kill(2);
+    os_kill(3);
+    strategyPassed();
+}
+#endif
+
+//! Calls the strategies directly and through the scheduler while the timer is stopped
+REGISTER_AUTOSTART(controller_program)
+void controller_program(void) {
+    // Disable scheduler timer
+    cbi(TCCR2B, CS22);
+    cbi(TCCR2B, CS21);
+    cbi(TCCR2B, CS20);
+
+#if TEST_SS_FAIR_SHARE
+    testFairShare();
+#endif
+#if TEST_SS_MLFQ
+    testMLFQ();
+#endif
+#if TEST_SS_COMPLETELY_FAIR
+    testCompletelyFair();
+#endif
+#if TEST_SS_CYCLIC_EXECUTIVE
+    testCyclicExecutive();
+#endif
+
+    TEST_PASSED;
+    HALT;
+}
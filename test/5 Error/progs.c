@@ -4,6 +4,7 @@
 
 #include <avr/pgmspace.h>
 #include <avr/interrupt.h>
+#include <avr/power.h>
 #include <util/atomic.h>
 #include <stdbool.h>
 #include "lcd.h"
@@ -159,7 +160,8 @@ void program1(void) {
     // 3. Checking if the global interrupt flag is disabled during os_error
     // Disable scheduler timer
     TCCR2B   = 0;
-    // Configure our check timer for CTC, 1024 prescaler
+    // Configure our check timer for CTC, 1024 prescaler (the OS powers down unused timers)
+    power_timer1_enable();
     TCCR1A   = 0;
     TCCR1C   = 0;
     OCR1A    = 500;
@@ -0,0 +1,126 @@
+//-------------------------------------------------
+//          TestTask: Heap Benchmark
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_memory.h"
+#include "os_scheduler.h"
+
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#if VERSUCH < 3
+    #error "Please fix the VERSUCH-define"
+#endif
+
+#ifndef WRITE
+    #define WRITE(str) lcd_writeProgString(PSTR(str))
+#endif
+#define TEST_PASSED \
+    do ATOMIC { \
+        lcd_clear(); \
+        WRITE("  TEST PASSED   "); \
+    } while (0)
+#define TEST_FAILED(reason) \
+    do ATOMIC { \
+        lcd_clear(); \
+        WRITE("FAIL  "); \
+        WRITE(reason); \
+    } while (0)
+#define TEST_ASSERT(predicate, reason) \
+    do { \
+        if (!(predicate)) { \
+            TEST_FAILED(reason); \
+            HALT; \
+        } \
+    } while (0)
+
+//---- Adjust here what to measure ----------------
+// Size of the blocks the heap is fragmented with
+#define BLOCK_SIZE      24
+// Size of the allocations that are timed, larger than every hole
+#define REQUEST_SIZE    (2 * BLOCK_SIZE + 8)
+// Number of timed allocations per strategy
+#define ROUNDS          64
+//-------------------------------------------------
+
+#define MAX_BLOCKS 128
+
+MemAddr blocks[MAX_BLOCKS];
+uint8_t blockCount = 0;
+
+/*!
+ *  Fills three quarters of the heap with blocks and frees every other one,
+ *  so the strategies have to skip many short runs before they find one that
+ *  is large enough behind the blocks.
+ */
+void fragment(Heap *heap) {
+    MemAddr const limit = os_getUseStart(heap) + os_getUseSize(heap) / 4 * 3;
+    while (blockCount < MAX_BLOCKS) {
+        MemAddr const block = os_malloc(heap, BLOCK_SIZE);
+        TEST_ASSERT(block, "Heap too small");
+        blocks[blockCount++] = block;
+        if (block + BLOCK_SIZE >= limit) {
+            break;
+        }
+    }
+    for (uint8_t i = 0; i < blockCount; i += 2) {
+        os_free(heap, blocks[i]);
+    }
+}
+
+/*!
+ *  Times ROUNDS allocations (each freed right away) with a strategy and
+ *  writes the mean time of an allocation in microseconds.
+ */
+void measure(Heap *heap, AllocStrategy strategy) {
+    os_setAllocationStrategy(heap, strategy);
+    // The run behind the last block that was kept
+    MemAddr const expected = blocks[(blockCount & 1) ? blockCount - 2 : blockCount - 1] + BLOCK_SIZE;
+
+    Time const start = os_systemTime_augment();
+    for (uint8_t i = 0; i < ROUNDS; i++) {
+        MemAddr const addr = os_malloc(heap, REQUEST_SIZE);
+        TEST_ASSERT(addr == expected, "Wrong chunk");
+        os_free(heap, addr);
+    }
+    Time const counts = os_systemTime_augment() - start;
+
+    lcd_writeDec(counts * TC0_PRESCALER * 1000ul / (F_CPU / 1000ul) / ROUNDS);
+    WRITE("us ");
+}
+
+/*!
+ *  Fragments the internal heap and shows the mean allocation time of the
+ *  first-fit and the best-fit strategy. The allocations are checked to
+ *  find the only run that is large enough.
+ */
+REGISTER_AUTOSTART(heap_benchmark)
+void heap_benchmark(void) {
+    Heap *const heap = intHeap;
+    lcd_clear();
+    WRITE("Heap ");
+    lcd_writeDec(os_getUseSize(heap));
+    WRITE(" B");
+    fragment(heap);
+    TEST_ASSERT(os_getUsage(heap, os_getCurrentProc()) == blockCount / 2 * BLOCK_SIZE, "Wrong usage");
+
+    lcd_line2();
+    WRITE("F ");
+    measure(heap, OS_MEM_FIRST);
+    WRITE("B ");
+    measure(heap, OS_MEM_BEST);
+    os_setAllocationStrategy(heap, OS_MEM_FIRST);
+    delayMs(30 * DEFAULT_OUTPUT_DELAY);
+
+    for (uint8_t i = 1; i < blockCount; i += 2) {
+        os_free(heap, blocks[i]);
+    }
+    TEST_ASSERT(!os_getHeapUsage(heap), "Memory leaked");
+
+    TEST_PASSED;
+    HALT;
+}
@@ -0,0 +1,164 @@
+//-------------------------------------------------
+//          TestTask: Program Registry
+//-------------------------------------------------
+
+#include "lcd.h"
+#include "util.h"
+#include "os_core.h"
+#include "os_programs.h"
+#include "os_scheduler.h"
+
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#if VERSUCH < 3
+    #error "Please fix the VERSUCH-define"
+#endif
+
+#ifndef WRITE
+    #define WRITE(str) lcd_writeProgString(PSTR(str))
+#endif
+#define TEST_PASSED \
+    do ATOMIC { \
+        lcd_clear(); \
+        WRITE("  TEST PASSED   "); \
+    } while (0)
+#define TEST_FAILED(reason) \
+    do ATOMIC { \
+        lcd_clear(); \
+        WRITE("FAIL  "); \
+        WRITE(reason); \
+    } while (0)
+#define TEST_ASSERT(predicate, reason) \
+    do { \
+        if (!(predicate)) { \
+            TEST_FAILED(reason); \
+            HALT; \
+        } \
+    } while (0)
+
+// IDs of the programs, their positions in the registry below
+#define ID_REGISTRY 0
+#define ID_WORKER   1
+#define ID_TWIN     2
+#define ID_HUGE     3
+#define ID_SERVICE  4
+#define PROGRAMS    5
+
+void program_registry(void);
+void worker(void);
+void twin(void);
+void huge(void);
+void service(void);
+
+REGISTER_PROGRAMS(
+    PROGRAM("registry", program_registry, DEFAULT_PRIORITY, 128, OS_PF_AUTOSTART | OS_PF_SINGLETON | OS_PF_HIDDEN),
+    PROGRAM("worker", worker, 3, 64, OS_PF_SINGLETON),
+    PROGRAM("twin", twin, DEFAULT_PRIORITY, 64, 0),
+    PROGRAM("huge", huge, DEFAULT_PRIORITY, STACK_SIZE_PROC + 1, OS_PF_HIDDEN),
+    PROGRAM("service", service, DEFAULT_PRIORITY, 64, OS_PF_SYSTEM),
+)
+
+uint8_t volatile workerRuns = 0;
+
+//! Returns right away, so its process ends
+void worker(void) {
+    workerRuns++;
+}
+
+//! Runs until it is killed
+void twin(void) {
+    while (1) {
+        os_yield();
+    }
+}
+
+//! Must never run, its stack does not fit into a process
+void huge(void) {
+    TEST_FAILED("Huge started");
+    HALT;
+}
+
+//! Runs until it is killed
+void service(void) {
+    while (1) {
+        os_yield();
+    }
+}
+
+//! Waits until a process has ended
+void awaitEnd(ProcessID pid) {
+    while (os_getProcessSlot(pid)->state != OS_PS_UNUSED) {
+        os_yield();
+    }
+}
+
+//! Counts the processes that are not unused
+uint8_t countProcesses(void) {
+    uint8_t count = 0;
+    for (ProcessID pid = 0; pid < MAX_NUMBER_OF_PROCESSES; pid++) {
+        count += os_getProcessSlot(pid)->state != OS_PS_UNUSED;
+    }
+    return count;
+}
+
+/*!
+ *  Started by the registry itself (OS_PF_AUTOSTART). Checks the lookup of
+ *  programs and the checks of os_execProgram: singletons run at most once,
+ *  programs whose stack does not fit are refused and system programs are
+ *  moved to SYSTEM_GROUP.
+ */
+void program_registry(void) {
+    lcd_clear();
+    WRITE("Registry");
+
+    // Lookup
+    TEST_ASSERT(os_getNumberOfRegisteredPrograms() == PROGRAMS, "Wrong count");
+    TEST_ASSERT(os_lookupProgram("worker") == ID_WORKER, "Lookup");
+    TEST_ASSERT(os_lookupProgram("work") == INVALID_PROGRAM, "Lookup prefix");
+    TEST_ASSERT(os_findProgram(twin) == ID_TWIN, "Find");
+    TEST_ASSERT(os_getProgramSlot(ID_SERVICE) == service, "Slot");
+    TEST_ASSERT(os_getProgramSlot(PROGRAMS) == NULL, "Slot past end");
+    ProgramInfo info;
+    TEST_ASSERT(os_getProgramInfo(ID_WORKER, &info), "Info");
+    TEST_ASSERT(info.priority == 3 && info.stackSize == 64, "Info content");
+    TEST_ASSERT(!os_getProgramInfo(PROGRAMS, &info), "Info past end");
+    TEST_ASSERT(os_execProgram(PROGRAMS) == INVALID_PROCESS, "Exec past end");
+
+    // Singletons, the autostarted registry itself included
+    lcd_line2();
+    WRITE("Singleton ");
+    TEST_ASSERT(os_execProgram(ID_REGISTRY) == INVALID_PROCESS, "Second registry");
+    for (uint8_t run = 1; run <= 2; run++) {
+        ProcessID const pid = os_execProgram(ID_WORKER);
+        TEST_ASSERT(pid != INVALID_PROCESS, "Worker refused");
+        TEST_ASSERT(os_getProcessSlot(pid)->priority == 3, "Wrong priority");
+        TEST_ASSERT(os_execProgram(ID_WORKER) == INVALID_PROCESS, "Second worker");
+        // Once the worker returned, it may be started again
+        awaitEnd(pid);
+        TEST_ASSERT(workerRuns == run, "Worker not run");
+    }
+    ProcessID const first = os_execProgram(ID_TWIN);
+    ProcessID const second = os_execProgram(ID_TWIN);
+    TEST_ASSERT(first != INVALID_PROCESS && second != INVALID_PROCESS, "Twin refused");
+    os_kill(first);
+    os_kill(second);
+
+    // Stack check
+    WRITE("Stack ");
+    uint8_t const processes = countProcesses();
+    TEST_ASSERT(os_execProgram(ID_HUGE) == INVALID_PROCESS, "Huge accepted");
+    TEST_ASSERT(countProcesses() == processes, "Huge got a slot");
+
+    // System group
+    ProcessID const pid = os_execProgram(ID_SERVICE);
+    TEST_ASSERT(pid != INVALID_PROCESS, "Service refused");
+    TEST_ASSERT(os_getProcessSlot(pid)->group == SYSTEM_GROUP, "Wrong group");
+    TEST_ASSERT(os_getProcessSlot(os_getCurrentProc())->group == DEFAULT_GROUP, "Own group");
+    os_kill(pid);
+
+    delayMs(10 * DEFAULT_OUTPUT_DELAY);
+    TEST_PASSED;
+    HALT;
+}
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Transcodes UTF-8 text to HD44780 display codes as a C string literal.
+
+The result can be pasted into PSTR(...) and written with
+lcd_writeCodeProgString, which skips the UTF-8 decoding of lcd_writeChar.
+The table mirrors the REMAP table in src/SPOS/lcd.c.
+
+Usage: lcd_transcode.py TEXT...    (or the text lines on stdin)
+"""
+
+import sys
+
+# Custom chars registered by lcd_init (custom char 0 through its mirror 8)
+LCD_CC_IXI = 0x08
+LCD_CC_TILDE = 0x01
+LCD_CC_BACKSLASH = 0x02
+LCD_CC_MU = 0x03
+
+REMAP = {
+    "\\": LCD_CC_BACKSLASH,
+    "~": LCD_CC_TILDE,
+    "¥": 0x5C,
+    "°": 0xDF,
+    "µ": 0xE4,
+    "ß": 0xE2,
+    "ä": 0xE1,
+    "ö": 0xEF,
+    "÷": 0xFD,
+    "ü": 0xF5,
+    "Σ": 0xF6,
+    "Ω": 0xF4,
+    "α": 0xE0,
+    "ε": 0xE3,
+    "μ": LCD_CC_MU,
+    "π": 0xF7,
+    "ρ": 0xE6,
+    "σ": 0xE5,
+    "ⅺ": LCD_CC_IXI,
+    "←": 0x7F,
+    "→": 0x7E,
+    "√": 0xE8,
+    "□": 0xDB,
+    "▮": 0xFF,
+}
+
+# Characters the display lacks are shown as a box, like lcd_writeChar does
+UNKNOWN = 0xDB
+
+
+def transcode(text):
+    """Returns the display codes of the text."""
+    codes = []
+    for char in text:
+        if char in REMAP:
+            codes.append(REMAP[char])
+        elif ord(char) <= 0x7F:
+            codes.append(ord(char))
+        else:
+            codes.append(UNKNOWN)
+    return codes
+
+
+def c_literal(codes):
+    """Returns the codes as C string literal(s).
+
+    A hex escape is closed by starting a new literal, so that a following
+    hex digit is not taken as part of the escape.
+    """
+    parts = ['"']
+    for code in codes:
+        if code == ord('"') or code == ord("\\"):
+            parts.append("\\" + chr(code))
+        elif code == ord("\n"):
+            parts.append("\\n")
+        elif 0x20 <= code <= 0x7E:
+            parts.append(chr(code))
+        else:
+            parts.append(f'\\x{code:02X}" "')
+    parts.append('"')
+    return "".join(parts).replace(' ""', "")
+
+
+def main(argv):
+    texts = argv[1:] or [line.rstrip("\n") for line in sys.stdin]
+    for text in texts:
+        print(c_literal(transcode(text)))
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Formats the binary log written by os_flushLog.
+
+The device only records the flash address of each format string and the raw
+16 bit arguments. This script reads the format strings from the ELF file the
+device was flashed with and prints the formatted messages.
+
+Usage: spos_log.py SPOS.elf [LOG]
+
+LOG is a file or a serial device (e.g. the pty of simavr); stdin by default.
+The records arrive as CRC-protected frames, so other output in between, like
+the text of the shell or telemetry frames, is skipped. Damaged frames are
+skipped and counted on stderr.
+"""
+
+import re
+import struct
+import sys
+
+from spos_telemetry import frames
+
+SHT_NOBITS = 8
+SHF_ALLOC = 2
+FLASH_END = 0x800000  # avr-gcc maps RAM to 0x800000 and above
+
+SYNC = b"\xa5\x4c"  # LOG_SYNC1 LOG_SYNC2 in os_log.h
+SPEC = re.compile(r"%([-+ 0#]*)(\d*)(?:\.(\d+))?(l?)([diuxXcsS%])")
+
+
+class Flash:
+    """The allocated sections of an AVR ELF file that live in flash."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1:
+            raise ValueError(f"{path} is no 32 bit ELF file")
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (_, sh_type, flags, addr, offset, size) = struct.unpack_from(
+                "<IIIIII", data, shoff + i * shentsize)
+            if sh_type != SHT_NOBITS and flags & SHF_ALLOC and addr < FLASH_END:
+                self.sections.append((addr, data[offset:offset + size]))
+
+    def string(self, address):
+        for addr, content in self.sections:
+            if addr <= address < addr + len(content):
+                end = content.index(b"\0", address - addr)
+                return content[address - addr:end].decode("utf-8", "replace")
+        return f"<no string at 0x{address:04x}>"
+
+
+def format_record(flash, format_address, words):
+    fmt = flash.string(format_address)
+    words = list(words)
+
+    def convert(match):
+        flags, width, precision, long, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        value = words.pop(0) if words else 0
+        if long:
+            value |= (words.pop(0) if words else 0) << 16
+        bits = 32 if long else 16
+        if conversion in "di" and value >= 1 << (bits - 1):
+            value -= 1 << bits
+        spec = "%" + flags + width + ("." + precision if precision else "")
+        if conversion == "S":
+            return (spec + "s") % flash.string(value)
+        if conversion == "s":
+            return f"<ram 0x{value:04x}>"
+        if conversion == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        return (spec + {"i": "d", "u": "d"}.get(conversion, conversion)) % value
+
+    return SPEC.sub(convert, fmt)
+
+
+def records(stream, errors):
+    """Yields (format address, arguments) of the records in all intact frames."""
+    for payload in frames(stream, errors, SYNC):
+        count, format_address = struct.unpack_from("<BH", payload)
+        if len(payload) != 3 + 2 * count:
+            errors[0] += 1
+            continue
+        yield format_address, struct.unpack_from(f"<{count}H", payload, 3)
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.exit(__doc__)
+    flash = Flash(argv[1])
+    stream = open(argv[2], "rb", buffering=0) if len(argv) == 3 else sys.stdin.buffer
+    errors = [0]
+    for format_address, words in records(stream, errors):
+        print(format_record(flash, format_address, words), flush=True)
+    if errors[0]:
+        print(f"{errors[0]} damaged frames skipped", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
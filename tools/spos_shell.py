@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Runs commands on the SPOS shell over a serial port.
+
+Every command is sent as a line, and its output is printed once the shell
+shows its prompt again. Without commands on the command line, one command
+per line is read from stdin, so a bench script can be piped in.
+
+Usage: spos_shell.py [--log FILE] DEVICE [COMMAND...]
+
+DEVICE is a serial device, e.g. the pty simavr creates for the UART.
+Example: spos_shell.py /tmp/simavr-uart0 ps "nice 3 50" trace
+
+Telemetry frames that arrive while the shell waits for input are removed
+from the output, so their bytes are never taken for the prompt. So are the
+log frames the "log" command sends; with --log they are appended to FILE,
+which spos_log.py formats:
+    spos_shell.py --log log.bin /tmp/simavr-uart0 log
+    spos_log.py SPOS.elf log.bin
+"""
+
+import os
+import select
+import sys
+import termios
+
+BAUD_RATE = termios.B38400  # USART_BAUD_RATE in defines.h
+PROMPT = b"> "
+FRAME_START = b"\xa5"  # TELEMETRY_SYNC1 in os_telemetry.h, never part of text
+LOG_SYNC = b"\xa5\x4c"  # LOG_SYNC1 LOG_SYNC2 in os_log.h
+
+
+def strip_frames(data, log=None):
+    """Splits data into the text without the frames and an incomplete frame
+    at its end, which is completed by the next read. Log frames are written
+    to log if it is given."""
+    text = b""
+    while True:
+        start = data.find(FRAME_START)
+        if start < 0:
+            return text + data, b""
+        text += data[:start]
+        # sync1 sync2 length payload crc
+        if len(data) < start + 3 or len(data) < start + 3 + data[start + 2] + 2:
+            return text, data[start:]
+        end = start + 3 + data[start + 2] + 2
+        if log and data[start:start + 2] == LOG_SYNC:
+            log.write(data[start:end])
+        data = data[end:]
+
+
+class Shell:
+    """A connection to the shell on the other end of a serial device."""
+
+    def __init__(self, path, log=None):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        attrs = termios.tcgetattr(self.fd)
+        attrs[0] = 0                                  # iflag
+        attrs[1] = 0                                  # oflag
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attrs[3] = 0                                  # lflag
+        attrs[4] = attrs[5] = BAUD_RATE
+        attrs[6][termios.VMIN] = 1
+        attrs[6][termios.VTIME] = 0
+        termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+        self.pending = b""
+        self.frame = b""
+        self.log = log
+
+    def read_until_prompt(self):
+        while PROMPT not in self.pending:
+            text, self.frame = strip_frames(self.frame + os.read(self.fd, 256), self.log)
+            self.pending += text
+        output, self.pending = self.pending.split(PROMPT, 1)
+        return output
+
+    def drain(self, quiet_time=0.2):
+        """Discards everything the shell sends until it is quiet for a while."""
+        while select.select([self.fd], [], [], quiet_time)[0]:
+            os.read(self.fd, 256)
+        self.pending = self.frame = b""
+
+    def run(self, command):
+        os.write(self.fd, command.encode() + b"\r")
+        output = self.read_until_prompt()
+        # The shell echoes the command line first
+        output = output.split(b"\r\n", 1)[1] if b"\r\n" in output else b""
+        return output.replace(b"\r\n", b"\n").decode("ascii", "replace")
+
+
+def main(argv):
+    log = None
+    if len(argv) > 2 and argv[1] == "--log":
+        log = open(argv[2], "ab")
+        argv = argv[:1] + argv[3:]
+    if len(argv) < 2:
+        sys.exit(__doc__)
+    shell = Shell(argv[1], log)
+    # Get a fresh prompt, no matter what was typed before
+    os.write(shell.fd, b"\r")
+    shell.read_until_prompt()
+    shell.drain()
+    commands = argv[2:] or (line.strip() for line in sys.stdin)
+    for command in commands:
+        if command:
+            print(shell.run(command), end="", flush=True)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Receives the telemetry frames of os_telemetry and writes them as CSV.
+
+Shell output between the frames is ignored. Frames with a wrong CRC (e.g.
+because bytes were lost) are skipped and counted on stderr. The header is written with the first frame; the number of
+heaps and processes is taken from it.
+
+Usage: spos_telemetry.py [INPUT] [OUTPUT.csv]
+
+INPUT is a file or a serial device (e.g. the pty of simavr), stdin by
+default. The CSV goes to stdout unless OUTPUT is given.
+"""
+
+import csv
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+VERSION = 1
+STATES = "URrB"  # unused, ready, running, blocked (see ProcessState)
+HEADER = struct.Struct("<BIBHHHBHH")
+
+
+def crc_ccitt(data, crc=0xFFFF):
+    """The CRC of avr-libc's _crc_ccitt_update."""
+    for byte in data:
+        byte ^= crc & 0xFF
+        byte = (byte ^ (byte << 4)) & 0xFF
+        crc = ((byte << 8) | (crc >> 8)) ^ (byte >> 4) ^ (byte << 3)
+        crc &= 0xFFFF
+    return crc
+
+
+def frames(stream, errors, sync=SYNC):
+    """Yields the payloads of all intact frames that start with sync. The
+    log frames of os_flushLog have the same layout with other sync bytes."""
+    buffer = b""
+    while True:
+        start = buffer.find(sync)
+        # Keep a trailing first sync byte, the second one may follow
+        buffer = buffer[start:] if start >= 0 else buffer[-1:]
+        if start >= 0 and len(buffer) >= 3 and len(buffer) >= 3 + buffer[2] + 2:
+            end = 3 + buffer[2] + 2
+            crc, = struct.unpack_from("<H", buffer, end - 2)
+            if crc_ccitt(buffer[2:end - 2]) == crc:
+                yield buffer[3:end - 2]
+                buffer = buffer[end:]
+            else:
+                errors[0] += 1
+                buffer = buffer[1:]
+            continue
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        buffer += chunk
+
+
+def parse(payload):
+    """Splits a payload into the system values, the heaps and the processes."""
+    values = HEADER.unpack_from(payload)
+    if values[0] != VERSION:
+        raise ValueError(f"unknown telemetry version {values[0]}")
+    offset = HEADER.size
+    heaps = payload[offset]
+    free = struct.unpack_from(f"<{heaps}H", payload, offset + 1)
+    offset += 1 + 2 * heaps
+    count = payload[offset]
+    processes = [struct.unpack_from("<BIH", payload, offset + 1 + 7 * pid) for pid in range(count)]
+    return values[1:], free, processes
+
+
+def main(argv):
+    if len(argv) > 3:
+        sys.exit(__doc__)
+    source = open(argv[1], "rb", buffering=0) if len(argv) > 1 else sys.stdin.buffer
+    sink = open(argv[2], "w", newline="") if len(argv) > 2 else sys.stdout
+    writer = csv.writer(sink)
+    errors = [0]
+    header = False
+
+    for payload in frames(source, errors):
+        system, free, processes = parse(payload)
+        if not header:
+            writer.writerow(
+                ["time_ms", "cpu_percent", "switches_per_s", "load_1s", "critical_max_counts",
+                 "critical_max_depth", "tick_latency_min", "tick_latency_max"]
+                + [f"heap{i}_free" for i in range(len(free))]
+                + [f"p{pid}_{column}" for pid in range(len(processes))
+                   for column in ("state", "cpu_counts", "stack")])
+            header = True
+        time, cpu, switches, load, critical, depth, latency_min, latency_max = system
+        writer.writerow(
+            [time, cpu, switches, f"{load / 2048:.2f}", critical, depth,
+             "" if latency_min == 0xFFFF else latency_min, latency_max]
+            + list(free)
+            + [value for state, ticks, stack in processes for value in (STATES[state & 3], ticks, stack)])
+        sink.flush()
+
+    if errors[0]:
+        print(f"{errors[0]} damaged frames skipped", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Turns the output of os_dumpTrace into a VCD file, e.g. for GTKWave.
+
+Every line "<time in hex> <letter> <argument>" is an event, all other lines
+(prompts, the "." of the shell's trace command, simavr log prefixes) are
+ignored. So the input may be a file of dumps collected with spos_shell.py
+("spos_shell.py trace >> trace.txt"), a capture of the USART or the console
+log of a simavr run whose firmware dumps the trace.
+
+The times are the low word of the system time in timer 0 counts. They are
+unwrapped assuming that less than one wrap (about 0.8 s at 20 MHz) passes
+between two consecutive events, which the scheduler interrupt guarantees
+within one dump. Between two dumps this only holds if they followed each
+other quickly enough.
+
+The VCD contains
+    proc<N>   the ProcessState of process N (0 unused, 1 ready, 2 running,
+              3 blocked), x until the first event of the process
+    running   the running process
+    isr       high while the scheduler interrupt runs
+    critical  high while a process is in a critical section
+    lcd       high while a process waits for the LCD
+
+With --filter FILE a GTKWave translate filter file is written, which shows
+the states of proc<N> by name (Data Format > Translate Filter File).
+
+Usage: spos_vcd.py [--f-cpu HZ] [--filter FILE] [INPUT] [OUTPUT.vcd]
+"""
+
+import argparse
+import re
+import sys
+
+TC0_PRESCALER = 256
+EVENT = re.compile(r"([0-9A-Fa-f]{4}) ([SBWEXIiCcLl]) (\d+)\s*$")
+UNUSED, READY, RUNNING, BLOCKED = range(4)
+STATE_NAMES = ("unused", "ready", "running", "blocked")
+MARKERS = {"I": ("isr", 1), "i": ("isr", -1),
+           "C": ("critical", 1), "c": ("critical", -1),
+           "L": ("lcd", 1), "l": ("lcd", -1)}
+
+
+def events(lines):
+    """Yields (time in timer 0 counts, letter, argument) with unwrapped times."""
+    now = None
+    previous = 0
+    for line in lines:
+        match = EVENT.search(line)
+        if not match:
+            continue
+        raw = int(match.group(1), 16)
+        now = raw if now is None else now + ((raw - previous) & 0xFFFF)
+        previous = raw
+        yield now, match.group(2), int(match.group(3))
+
+
+def changes(trace):
+    """Yields (time, {signal: value}) for every time at which signals change."""
+    state = {}
+    nesting = {"isr": 0, "critical": 0, "lcd": 0}
+    running = None
+    for time, letter, arg in trace:
+        update = {}
+        if letter in MARKERS:
+            name, step = MARKERS[letter]
+            nesting[name] = max(nesting[name] + step, 0)
+            update[name] = int(nesting[name] > 0)
+        elif letter == "S":
+            if running is not None and state.get(running) == RUNNING:
+                state[running] = READY
+                update["proc%d" % running] = READY
+            running = arg
+            state[arg] = RUNNING
+            update["proc%d" % arg] = RUNNING
+            update["running"] = arg
+        else:
+            state[arg] = {"E": READY, "W": READY, "B": BLOCKED, "X": UNUSED}[letter]
+            update["proc%d" % arg] = state[arg]
+        yield time, update
+
+
+def write_vcd(out, trace, f_cpu):
+    """Writes the events as VCD with a timescale of 1 ns."""
+    trace = list(trace)
+    pids = sorted({arg for _, letter, arg in trace if letter in "SBWEX"})
+    signals = [("isr", 1), ("critical", 1), ("lcd", 1), ("running", 8)]
+    signals += [("proc%d" % pid, 2) for pid in pids]
+    codes = {name: chr(33 + i) for i, (name, _) in enumerate(signals)}
+    widths = dict(signals)
+
+    def value(name, val):
+        if widths[name] == 1:
+            return "%s%s" % (val, codes[name])
+        bits = "x" if val is None else format(val, "b")
+        return "b%s %s" % (bits, codes[name])
+
+    out.write("$timescale 1 ns $end\n$scope module spos $end\n")
+    for name, width in signals:
+        out.write("$var wire %d %s %s $end\n" % (width, codes[name], name))
+    out.write("$upscope $end\n$enddefinitions $end\n")
+    if not trace:
+        return
+    out.write("#0\n$dumpvars\n")
+    for name, _ in signals:
+        out.write(value(name, 0 if widths[name] == 1 else None) + "\n")
+    out.write("$end\n")
+
+    start = trace[0][0]
+    last = 0
+    for time, update in changes(trace):
+        ns = (time - start) * TC0_PRESCALER * 10**9 // f_cpu
+        if ns != last:
+            out.write("#%d\n" % ns)
+            last = ns
+        for name, val in update.items():
+            out.write(value(name, val) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--f-cpu", type=int, default=20000000,
+                        help="clock frequency of the AVR in Hz (default 20 MHz)")
+    parser.add_argument("--filter", help="also write a GTKWave translate filter file")
+    parser.add_argument("input", nargs="?", help="trace dump, stdin by default")
+    parser.add_argument("output", nargs="?", help="VCD file, stdout by default")
+    args = parser.parse_args()
+
+    if args.filter:
+        with open(args.filter, "w") as stream:
+            for state, name in enumerate(STATE_NAMES):
+                stream.write("%d %s\n" % (state, name))
+
+    source = open(args.input, errors="replace") if args.input else sys.stdin
+    out = open(args.output, "w") if args.output else sys.stdout
+    with source, out:
+        write_vcd(out, events(source), args.f_cpu)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Checks that spos_log.py decodes the frames os_flushLog writes.
+
+The frames are built as described in os_log.c with the sync bytes taken
+from os_log.h, and the format strings are those of the os_log calls in
+os_scheduler.c, placed in a small ELF file like avr-gcc places them in
+flash. The frames are mixed with shell text, a telemetry frame and a
+damaged frame, as on the USART.
+
+Usage: test_spos_log.py (or python3 -m unittest in tools/)
+"""
+
+import io
+import os
+import re
+import struct
+import tempfile
+import unittest
+
+import spos_log
+from spos_telemetry import crc_ccitt
+
+SPOS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "SPOS")
+FLASH_ADDRESS = 0x100
+
+
+def read(name):
+    with open(os.path.join(SPOS, name)) as stream:
+        return stream.read()
+
+
+def log_sync():
+    header = read("os_log.h")
+    return bytes(int(re.search(r"#define LOG_SYNC%d (0x[0-9A-Fa-f]+)" % i, header).group(1), 16)
+                 for i in (1, 2))
+
+
+def write_elf(path, address, content):
+    """Writes a 32 bit ELF file with a single allocated section at address."""
+    shstrtab = b"\0.progmem\0.shstrtab\0"
+    data_offset = 52
+    strtab_offset = data_offset + len(content)
+    shoff = strtab_offset + len(shstrtab)
+    header = b"\x7fELF\x01\x01\x01" + bytes(9) + struct.pack(
+        "<HHIIIIIHHHHHH", 2, 83, 1, 0, 0, shoff, 0, 52, 0, 0, 40, 3, 2)
+    sections = bytes(40)
+    sections += struct.pack("<IIIIIIIIII", 1, 1, 2, address, data_offset, len(content), 0, 0, 1, 0)
+    sections += struct.pack("<IIIIIIIIII", 10, 3, 0, 0, strtab_offset, len(shstrtab), 0, 0, 1, 0)
+    with open(path, "wb") as stream:
+        stream.write(header + content + shstrtab + sections)
+
+
+def frame(sync, record):
+    crc = crc_ccitt(bytes([len(record)]) + record)
+    return sync + bytes([len(record)]) + record + struct.pack("<H", crc)
+
+
+def record(format_address, *words):
+    return struct.pack("<BH%dH" % len(words), len(words), format_address, *words)
+
+
+class KnownRecords(unittest.TestCase):
+    def setUp(self):
+        self.formats = re.findall(r'os_log\("((?:[^"\\]|\\.)*)"', read("os_scheduler.c"))
+        self.formats.append("pid %u slept %lu ms in %S")
+        content = b""
+        self.addresses = {}
+        for fmt in self.formats:
+            self.addresses[fmt] = FLASH_ADDRESS + len(content)
+            content += fmt.encode() + b"\0"
+        self.addresses["name"] = FLASH_ADDRESS + len(content)
+        content += b"counter\0"
+        with tempfile.NamedTemporaryFile(suffix=".elf", delete=False) as stream:
+            self.elf = stream.name
+        write_elf(self.elf, FLASH_ADDRESS, content)
+        self.flash = spos_log.Flash(self.elf)
+
+    def tearDown(self):
+        os.unlink(self.elf)
+
+    def test_crc_is_the_one_of_avr_libc(self):
+        self.assertEqual(crc_ccitt(b"123456789"), 0x6F91)
+
+    def test_decodes_known_records(self):
+        started, ended = self.formats[:2]
+        self.assertEqual((started, ended), ("pid %u started at priority %u", "pid %u ended"))
+        sync = log_sync()
+        damaged = bytearray(frame(sync, record(self.addresses[ended], 4)))
+        damaged[5] ^= 1
+        stream = io.BytesIO(
+            b"> log\r\n"
+            + frame(sync, record(self.addresses[started], 3, 10))
+            + frame(b"\xa5\x5a", b"\x01telemetry")
+            + bytes(damaged)
+            + frame(sync, record(self.addresses[self.formats[2]], 3, *struct.unpack("<HH", struct.pack("<I", 100000)),
+                                 self.addresses["name"]))
+            + frame(sync, record(self.addresses[ended], 3))
+            + b"1 dropped\r\n> ")
+        errors = [0]
+        lines = [spos_log.format_record(self.flash, address, words)
+                 for address, words in spos_log.records(stream, errors)]
+        self.assertEqual(lines, ["pid 3 started at priority 10",
+                                 "pid 3 slept 100000 ms in counter",
+                                 "pid 3 ended"])
+        self.assertEqual(errors, [1])
+
+
+if __name__ == "__main__":
+    unittest.main()
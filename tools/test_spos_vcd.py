@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""Checks that spos_vcd.py reads what os_dumpTrace writes.
+
+The format string and the event letters are taken from os_trace.c, and the
+lines are formatted the way os_printf_P does (hex digits in uppercase, see
+os_format.c). So a change of the dump format that the tool does not follow
+makes this test fail.
+
+Usage: test_spos_vcd.py (or python3 -m unittest in tools/)
+"""
+
+import io
+import os
+import re
+import unittest
+
+import spos_vcd
+
+SOURCE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "SPOS", "os_trace.c")
+
+
+def read_source():
+    with open(SOURCE) as stream:
+        return stream.read()
+
+
+def dump_format(source):
+    """The format string os_dumpTrace passes to os_printf_P."""
+    body = source[source.index("void os_dumpTrace("):]
+    match = re.search(r'os_printf_P\(stream, PSTR\("((?:[^"\\]|\\.)*)"\)', body)
+    return match.group(1).encode().decode("unicode_escape")
+
+
+def event_letters(source):
+    """Maps the event type names to the letters os_dumpTrace writes."""
+    table = source[source.index("eventLetters[OS_TE_COUNT]"):]
+    table = table[:table.index("};")]
+    return dict(re.findall(r"\[(OS_TE_\w+)\] = '(.)'", table))
+
+
+def printf_p(format, *args):
+    """Formats like os_printf_P for the conversions the dump uses."""
+    args = list(args)
+
+    def convert(match):
+        pad, width, conversion = match.groups()
+        value = args.pop(0)
+        if conversion in "xX":
+            text = "%X" % value
+        elif conversion == "c":
+            text = value
+        else:
+            text = "%u" % value
+        return text.rjust(int(width or 0), "0" if pad else " ")
+
+    return re.sub(r"%(0?)(\d*)l?([uxXc])", convert, format)
+
+
+class DumpRoundTrip(unittest.TestCase):
+    def setUp(self):
+        source = read_source()
+        self.format = dump_format(source)
+        self.letters = event_letters(source)
+
+    def dump(self, events):
+        return io.StringIO("".join(printf_p(self.format, time, self.letters[name], arg)
+                                   for time, name, arg in events))
+
+    def test_every_letter_is_read(self):
+        events = [(0x10 * i, name, i) for i, name in enumerate(sorted(self.letters))]
+        parsed = list(spos_vcd.events(self.dump(events)))
+        self.assertEqual(parsed, [(time, self.letters[name], arg) for time, name, arg in events])
+
+    def test_hex_digits_above_nine(self):
+        events = [(0xABCD, "OS_TE_SWITCH", 1), (0xFFFE, "OS_TE_SWITCH", 2), (0x0003, "OS_TE_SWITCH", 1)]
+        times = [time for time, _, _ in spos_vcd.events(self.dump(events))]
+        self.assertEqual(times, [0xABCD, 0xFFFE, 0x10003])
+
+    def test_every_letter_changes_a_signal(self):
+        events = [(i, name, 1) for i, name in enumerate(sorted(self.letters))]
+        trace = list(spos_vcd.events(self.dump(events)))
+        self.assertTrue(all(update for _, update in spos_vcd.changes(trace)))
+
+
+if __name__ == "__main__":
+    unittest.main()